@@ -0,0 +1,102 @@
+#include "../lib/batch.h"
+#include "../lib/regex.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/* Number of candidate strings matched per run */
+#define BENCH_INPUTS 1000000
+
+/* Timed runs per thread count; the fastest one is reported */
+#define BENCH_REPEATS 3
+
+/*
+ * Function: MakeInputs
+ *
+ *  Generate identifier-like candidates of 4 to 64 bytes. Roughly half of
+ *  them contain a byte that the benchmark pattern rejects.
+ *
+ *  @return The candidates
+ */
+static std::vector<std::string> MakeInputs() {
+  std::mt19937 random(42);
+  std::vector<std::string> inputs(BENCH_INPUTS);
+  for (std::string &input : inputs) {
+    int length = 4 + random() % 61;
+    for (int i = 0; i < length; i++) {
+      input += 'a' + random() % 26;
+    }
+    if (random() % 2 == 0) {
+      input[random() % length] = '-';
+    }
+  }
+  return inputs;
+}
+
+/*
+ * Function: TimeBatch
+ *
+ *  @return Best wall time of BENCH_REPEATS runs, in seconds
+ */
+template <typename Automaton>
+static double TimeBatch(BatchMatcher &matcher, const Automaton &automaton,
+                        const std::vector<std::string> &inputs,
+                        size_t &accepted) {
+  double best = 0;
+  for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+    auto start = std::chrono::steady_clock::now();
+    BatchResult result = matcher.match(automaton, inputs);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    accepted = result.acceptedCount();
+    if (repeat == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+/*
+ * Function: main
+ *
+ *  Match the same inputs with 1, 2, 4, ... threads up to the hardware thread
+ *  count, for both the NFA and the DFA engine, and print the throughput and
+ *  the speedup over one thread. An argument overrides the largest thread
+ *  count.
+ */
+int main(int argc, char **argv) {
+  // Identifiers with an optional trailing digit run: (a-z)+ (0-9)*
+  NfaHandle pattern = ConcatNFA(PlusNFA(RangeNFA('a', 'z', "id")),
+                                KleeneStarNFA(RangeNFA('0', '9', "id")));
+  FrozenNFA nfa = freeze(pattern.start);
+  DFA dfa = CompileDFA(nfa);
+  std::vector<std::string> inputs = MakeInputs();
+
+  int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+  int maxThreads = argc > 1 ? std::max(1, atoi(argv[1])) : hardwareThreads;
+  std::vector<int> threadCounts;
+  for (int threads = 1; threads < maxThreads; threads *= 2) {
+    threadCounts.push_back(threads);
+  }
+  threadCounts.push_back(maxThreads);
+
+  printf("%d inputs, %d hardware threads\n", BENCH_INPUTS, hardwareThreads);
+  printf("%-8s %8s %14s %9s %10s\n", "engine", "threads", "inputs/s",
+         "speedup", "accepted");
+  for (int engine = 0; engine < 2; engine++) {
+    double baseline = 0;
+    for (int threads : threadCounts) {
+      BatchMatcher matcher(threads);
+      size_t accepted;
+      double seconds = engine == 0 ? TimeBatch(matcher, nfa, inputs, accepted)
+                                   : TimeBatch(matcher, dfa, inputs, accepted);
+      if (threads == 1) {
+        baseline = seconds;
+      }
+      printf("%-8s %8d %14.0f %8.2fx %10zu\n", engine == 0 ? "nfa" : "dfa",
+             threads, BENCH_INPUTS / seconds, baseline / seconds, accepted);
+    }
+  }
+  return 0;
+}
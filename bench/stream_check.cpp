@@ -0,0 +1,175 @@
+#include "../lib/regex.h"
+#include "../lib/stream.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+/* Candidate strings matched per pattern */
+#define CHECK_INPUTS 2000
+
+/* Cache budget small enough to make the LazyDFA flush and fall back */
+#define CHECK_SMALL_BUDGET 4096
+
+/* Positions after the last 'a' in the thrashing pattern */
+#define CHECK_TAIL_LENGTH 8
+
+/*
+ * Function: IdentifierPattern
+ *
+ *  @return (a-z)+ (0-9)*, whose DFA is small
+ */
+static FrozenNFA IdentifierPattern() {
+  NfaHandle pattern = ConcatNFA(PlusNFA(RangeNFA('a', 'z', "id")),
+                                KleeneStarNFA(RangeNFA('0', '9', "id")));
+  return freeze(pattern.start);
+}
+
+/*
+ * Function: TailPattern
+ *
+ *  @return (a|b)* a (a|b)^CHECK_TAIL_LENGTH, whose DFA needs a state for each
+ *  combination of the last bytes and so outgrows a small cache
+ */
+static FrozenNFA TailPattern() {
+  NfaHandle pattern = ConcatNFA(KleeneStarNFA(BracketNFA({'a', 'b'}, "tail")),
+                                LiteralNFA("a", "tail"));
+  for (int i = 0; i < CHECK_TAIL_LENGTH; i++) {
+    pattern = ConcatNFA(pattern, BracketNFA({'a', 'b'}, "tail"));
+  }
+  return freeze(pattern.start);
+}
+
+/*
+ * Function: MakeInputs
+ *
+ *  Generate candidates of 0 to 200 bytes over the given alphabet.
+ *
+ *  @return The candidates
+ */
+static std::vector<std::string> MakeInputs(const std::string &alphabet) {
+  std::mt19937 random(42);
+  std::vector<std::string> inputs(CHECK_INPUTS);
+  for (std::string &input : inputs) {
+    int length = random() % 201;
+    for (int i = 0; i < length; i++) {
+      input += alphabet[random() % alphabet.size()];
+    }
+  }
+  return inputs;
+}
+
+/*
+ * Function: FeedInChunks
+ *
+ *  Feed an input to a matcher in pieces of 1 to chunkLimit bytes.
+ *
+ *  @return What the matcher returns once the input ends
+ */
+static int64_t FeedInChunks(StreamMatcher &matcher, const std::string &input,
+                            size_t chunkLimit, std::mt19937 &random) {
+  matcher.reset();
+  size_t offset = 0;
+  while (offset < input.size()) {
+    size_t length = std::min(input.size() - offset,
+                             (size_t)(1 + random() % chunkLimit));
+    matcher.feed(input.data() + offset, length);
+    offset += length;
+  }
+  return matcher.finish();
+}
+
+/*
+ * Function: CheckPattern
+ *
+ *  Match every input through NFA, DFA and LazyDFA stream matchers, fed in
+ *  chunks, through MatchStream and through MatchFile, and compare each
+ *  result with MatchNFA on the whole input. Two matchers built from the same
+ *  small-budget LazyDFA are interleaved, so their caches flush in the middle
+ *  of each other's matches.
+ *
+ *  @return Number of mismatches
+ */
+static int CheckPattern(const char *name, const FrozenNFA &nfa,
+                        const std::vector<std::string> &inputs,
+                        const std::string &scratchFile) {
+  DFA dfa = CompileDFA(nfa);
+  LazyDFA lazyDFA(nfa);
+  LazyDFA smallDFA(nfa, CHECK_SMALL_BUDGET);
+  MatchScratch scratch(nfa);
+
+  std::vector<StreamMatcher> matchers;
+  matchers.emplace_back(nfa);
+  matchers.emplace_back(dfa);
+  matchers.emplace_back(lazyDFA);
+  matchers.emplace_back(smallDFA);
+  StreamMatcher first(smallDFA);
+  StreamMatcher second(smallDFA);
+
+  std::mt19937 random(7);
+  int mismatches = 0;
+  auto check = [&](const char *engine, const std::string &input,
+                   int64_t expected, int64_t actual) {
+    if (actual != expected) {
+      fprintf(stderr, "%s/%s: \"%s\" matched %lld, expected %lld\n", name,
+              engine, input.c_str(), (long long)actual, (long long)expected);
+      mismatches++;
+    }
+  };
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const std::string &input = inputs[i];
+    int64_t expected = MatchNFA(nfa, input, scratch).length;
+    const char *engines[] = {"nfa", "dfa", "lazy", "small"};
+    for (size_t m = 0; m < matchers.size(); m++) {
+      check(engines[m], input, expected,
+            FeedInChunks(matchers[m], input, 1 + i % 16, random));
+    }
+
+    // Alternate bytes between two matchers sharing one LazyDFA
+    const std::string &other = inputs[(i + 1) % inputs.size()];
+    first.reset();
+    second.reset();
+    for (size_t offset = 0; offset < std::max(input.size(), other.size());
+         offset++) {
+      if (offset < input.size()) {
+        first.feed(input.data() + offset, 1);
+      }
+      if (offset < other.size()) {
+        second.feed(other.data() + offset, 1);
+      }
+    }
+    check("interleaved", input, expected, first.finish());
+    check("interleaved", other, MatchNFA(nfa, other, scratch).length,
+          second.finish());
+
+    std::istringstream stream(input);
+    check("stream", input, expected, MatchStream(matchers[i % 4], stream));
+
+    if (i % 100 == 0) {
+      std::ofstream(scratchFile, std::ios::binary) << input;
+      check("file", input, expected, MatchFile(matchers[i % 4], scratchFile));
+    }
+  }
+
+  printf("%-6s %zu inputs, %d mismatches\n", name, inputs.size(), mismatches);
+  return mismatches;
+}
+
+/*
+ * Function: main
+ *
+ *  Check the stream matchers of every engine against MatchNFA.
+ *
+ *  @return 0 if every result agrees; otherwise, 1
+ */
+int main() {
+  std::string scratchFile = "bin/stream_check.input";
+  int mismatches = 0;
+  mismatches += CheckPattern("ident", IdentifierPattern(),
+                             MakeInputs("abcxyz0189-"), scratchFile);
+  mismatches += CheckPattern("tail", TailPattern(), MakeInputs("aab"),
+                             scratchFile);
+  remove(scratchFile.c_str());
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "../include/logger.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* Default size cap of the binary cache, in bytes */
+#define BINARY_CACHE_BUDGET_DEFAULT (64 << 20)
+
+// -----------------------------------------------------------------------------
+// BinaryCache Class
+// -----------------------------------------------------------------------------
+// The BinaryCache class keeps compiled script binaries keyed by a hash of the
+// generated sources and the runtime library sources, so a script whose
+// generated code has not changed runs without invoking make. Entries are
+// evicted least recently used first once the cache grows past its size cap.
+// Hit, miss and eviction counts persist in a stats file next to the entries.
+// Files that have not changed since they were last hashed are not read again,
+// which the server mode relies on to hash the runtime library only once.
+class BinaryCache {
+public:
+  BinaryCache(const std::string &cache_directory, uintmax_t size_budget);
+
+  // Hash of every source file and Makefile in the given directories
+  std::string hashBuildInputs(const std::vector<std::string> &directories);
+
+  // Path of the cached binary for a key, or "" on a miss
+  std::string lookup(const std::string &key);
+  // Copies a freshly built binary into the cache and evicts old entries
+  void store(const std::string &key, const std::string &binary_path);
+
+  std::string describe();
+
+private:
+  std::filesystem::path directory;
+  uintmax_t sizeBudget;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+
+  // Hash of a file's contents, and the file's state when it was taken
+  struct FileDigest {
+    std::filesystem::file_time_type writeTime;
+    uintmax_t size;
+    uint64_t hash;
+    std::filesystem::file_time_type hashedAt;
+  };
+  std::unordered_map<std::string, FileDigest> digests;
+
+  uint64_t hashFile(const std::filesystem::path &path);
+  void loadStats();
+  void saveStats();
+  void evict();
+};
+
+#endif /* CACHE_H */
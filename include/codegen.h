@@ -1,16 +1,38 @@
 #ifndef CODEGEN_H
 #define CODEGEN_H
 
+#include "../include/interpret.h"
 #include "../include/logger.h"
 #include "../include/transpiler_types.h"
+#include "../lib/dfa.h"
+#include "../lib/regex.h"
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Macro defn. for simpler syntax
 #define GEN(line, out) (out) << (line) << std::endl;
 
+// -----------------------------------------------------------------------------
+// CodegenOptions
+// -----------------------------------------------------------------------------
+// Settings that change what the generated program looks like. The engine
+// decides which runtime matcher TEST statements are compiled against.
+struct CodegenOptions {
+  enum class Engine { NFA, LazyDFA, DFA, BitNFA, Direct, Table } engine;
+  size_t dfaCacheBudget; // 0 keeps the runtime default
+  bool reportStats;      // Generated program prints automaton sizes to stderr
+  bool foldTests;        // TESTs are evaluated while transpiling
+
+  CodegenOptions()
+      : engine(Engine::NFA), dfaCacheBudget(0), reportStats(false),
+        foldTests(false) {};
+};
+
 // -----------------------------------------------------------------------------
 // CodeGenerator Class
 // -----------------------------------------------------------------------------
@@ -19,31 +41,75 @@
 class CodeGenerator {
 public:
   // CodeGenerator constructor
-  explicit CodeGenerator(std::string file_location,
-                         const std::vector<Instruction> &instruction_list);
+  explicit CodeGenerator(std::string file_location, Program &&parsed_program,
+                         const CodegenOptions &codegen_options = {},
+                         AutomatonCache *automaton_cache = nullptr);
   ~CodeGenerator();
 
   // Main Function
   void generateCode();
 
+  // With foldTests, true if the whole output of the program is known
+  bool hasStaticOutput() const { return outputIsStatic; }
+  const std::string &getStaticOutput() const { return staticOutput; }
+
 private:
   // Private member variables
-  const std::vector<Instruction> instructionList;
+  const Program program;
   std::string fileLocation;
+  CodegenOptions options;
+  std::unordered_set<std::string> declaredVariables;
+  // Variables that SEARCH, FINDALL, TESTALL or an unfolded TEST need as an
+  // NFA at runtime
+  std::unordered_set<std::string> searchedVariables;
+  // Variables that SEARCH or FINDALL run on; they get a `<var>_searcher`
+  std::unordered_set<std::string> searcherVariables;
+  // Direct and table engines: generated matcher of each variable
+  std::unordered_map<std::string, std::string> compiledMatchers;
+  int compiledMatcherCount;
+  // TESTALL: generated PatternSet of each member list, keyed by
+  // PatternSetKey, and the keys whose set is up to date
+  std::unordered_map<std::string, std::string> patternSetNames;
+  std::unordered_set<std::string> builtPatternSets;
+  // False if the generated program uses nothing from libautomata.a
+  bool runtimeLibrary;
+  // Automata built while transpiling, keyed by ExpKey
+  AutomatonCache ownAutomata;
+  AutomatonCache *automata;
+  // Folded TESTs: key of the automaton in each variable, and the result of
+  // each key and input
+  std::unordered_map<std::string, std::string> foldedAutomata;
+  std::unordered_map<std::string, bool> foldedResults;
+  std::string staticOutput;
+  bool outputIsStatic;
 
   std::ofstream mainOutput;
   std::ofstream makeFile;
   std::ofstream complexCode;
+  std::ofstream complexHeader;
 
   // Private class functions
-  void generateTestCode(TestData *testData);
-  void generatePrintCode(PrintData *printData);
-  void generateAssignCode(AssignData *assignData);
+  void generateTestCode(const TestData *testData);
+  bool generateFoldedTestCode(const TestData *testData);
+  void foldAssignment(const std::string &lhs, NodeId rhs);
+  void generateTestAllCode(const TestAllData *testAllData);
+  void generateSearchCode(const TestData *searchData);
+  void generateFindAllCode(const TestData *findAllData);
+  void generateTestFileCode(const TestData *testFileData);
+  void generateSearchStatsCode(const std::string &nfa_name);
+  void generatePrintCode(const PrintData *printData);
+  void generateAssignCode(const AssignData *assignData);
+  void generateMatcherCode(const std::string &lhs, bool declare);
+  bool generateCompiledMatcher(const std::string &lhs, NodeId rhs);
+  void writeDirectMatcher(const DFA &dfa, const std::string &function_name);
+  void writeTableMatcher(const DFA &dfa, const std::string &table_name);
+  void collectSearchedVariables();
+  bool needsRuntimeLibrary();
 
   // Assign class function
-  std::string generateRhsCode(Exp *rhs);
-  std::string generateExpP2Code(Exp_p2 *exp_p2);
-  std::string generateExpP1Code(Exp_p1 *exp_p1);
+  std::string generateRhsCode(NodeId rhs);
+  std::string generateExpP2Code(const Exp_p2 *exp_p2);
+  std::string generateExpP1Code(const Exp_p1 *exp_p1);
 
   void generateMakefile();
   void generateImplicitCode();
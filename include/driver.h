@@ -0,0 +1,55 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "../include/cache.h"
+#include "../include/codegen.h"
+#include "../include/interpret.h"
+#include "../include/transpiler_types.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Settings of the transpiler itself, as opposed to the generated code
+struct DriverOptions {
+  bool interpret;          // Run the script in-process
+  uintmax_t cacheBudget;   // Size cap of bin/cache/; 0 disables the cache
+  bool cacheStats;         // Report cache hits and size to stderr
+  bool serve;              // Stay resident and run the scripts clients send
+  std::string serveSocket; // Unix socket to serve on; "" serves stdin
+
+  DriverOptions()
+      : interpret(false), cacheBudget(BINARY_CACHE_BUDGET_DEFAULT),
+        cacheStats(false), serve(false) {};
+};
+
+// -----------------------------------------------------------------------------
+// Driver Class
+// -----------------------------------------------------------------------------
+// The Driver class runs a script through every stage: tokenizing, parsing,
+// validation, and then interpreting or generating, compiling and running
+// C++. State that does not depend on the script is kept between runs: the
+// binary cache, the automata of expressions, and the validated programs of
+// sources seen before.
+class Driver {
+public:
+  Driver(const CodegenOptions &codegen_options,
+         const DriverOptions &driver_options);
+
+  // Both return the exit status of the run
+  int runFile(const std::string &source_file);
+  int runSource(std::string_view input);
+
+private:
+  CodegenOptions options;
+  DriverOptions driver;
+  std::unique_ptr<BinaryCache> binaryCache;
+  AutomatonCache automata;
+  // Validated programs, keyed by the hash and size of their source
+  std::unordered_map<std::string, Program> programs;
+
+  bool parseSource(std::string_view input, Program &program);
+  int buildAndRun(Program &&program);
+};
+
+#endif /* DRIVER_H */
@@ -0,0 +1,69 @@
+#ifndef INTERPRET_H
+#define INTERPRET_H
+
+#include "../include/logger.h"
+#include "../include/transpiler_types.h"
+#include "../lib/frozen.h"
+#include "../lib/patternset.h"
+#include "../lib/regex.h"
+#include "../lib/search.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Frozen automata of expressions, keyed by ExpKey. Shared between runs by the
+// server mode so an expression is only built once.
+typedef std::unordered_map<std::string, FrozenNFA> AutomatonCache;
+
+// -----------------------------------------------------------------------------
+// Interpreter Class
+// -----------------------------------------------------------------------------
+// The Interpreter class runs a validated instruction list directly against
+// the runtime library linked into the transpiler, printing what the generated
+// program would print without writing or compiling any C++.
+class Interpreter {
+public:
+  explicit Interpreter(Program &&parsed_program,
+                       AutomatonCache *automaton_cache = nullptr);
+
+  // Main function
+  int run();
+
+private:
+  const Program program;
+  AutomatonCache ownAutomata;
+  AutomatonCache *automata;
+  // Automaton currently held by each variable, owned by automata
+  std::unordered_map<std::string, const FrozenNFA *> variables;
+  // PatternSet of each TESTALL member list, keyed by PatternSetKey. Dropped
+  // when a member is reassigned.
+  std::unordered_map<std::string, PatternSet> patternSets;
+  // Searcher of each variable SEARCH or FINDALL ran on, built on first use.
+  // Dropped when the variable is reassigned.
+  std::unordered_map<std::string, Searcher> searchers;
+
+  void runTest(const TestData *testData);
+  void runTestAll(const TestAllData *testAllData);
+  void runSearch(const TestData *searchData);
+  void runFindAll(const TestData *findAllData);
+  void runTestFile(const TestData *testFileData);
+  bool runAssign(const AssignData *assignData);
+  Searcher &searcherOf(const std::string &nfa_name);
+};
+
+// Builds the NFA of an expression with the runtime library. Returns a handle
+// with a null start for expressions the code generator cannot generate.
+NfaHandle BuildExpNFA(const Program &program, NodeId exp);
+// Canonical text of an expression, "" for the ones BuildExpNFA cannot build
+std::string ExpKey(const Program &program, NodeId exp);
+// Frozen automaton of an expression, built on the first request for its key.
+// Returns nullptr for expressions BuildExpNFA cannot build.
+const FrozenNFA *CompileExp(const Program &program, NodeId exp,
+                            AutomatonCache &cache);
+// Member list of a TESTALL as text, for reusing its PatternSet
+std::string PatternSetKey(const std::vector<std::string> &names);
+// Whether a variable is one of the members a PatternSetKey lists
+bool PatternSetHasMember(const std::string &key, const std::string &name);
+
+#endif /* INTERPRET_H */
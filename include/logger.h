@@ -10,6 +10,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 /* Logger macro */
 #define LOG(msg) logger.log(msg)
@@ -25,7 +27,7 @@ public:
   ~Logger();
 
   void log(const std::string &message);
-  void log_tokens(std::vector<std::string> tokens);
+  void log_tokens(const std::vector<Token> &tokens, std::string_view source);
 
 private:
   std::ofstream logFile;
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include "../include/transpiler_types.h"
 #include "../include/logger.h"
 
@@ -15,29 +16,41 @@
 class Parser{
 public:
   // Parser constructor
-  explicit Parser(const std::vector<std::string>& token_list);
+  Parser(const std::vector<Token>& token_list, std::string_view source_text);
 
   // Main Function
-  std::vector<Instruction> mainParser();
+  Program mainParser();
 
 private:
-  const std::vector<std::string> tokens;
+  // Tokens of the source, owned by the caller, who keeps them alive while
+  // the parser is used
+  const std::vector<Token> &tokens;
+  // Source text the tokens are spans of
+  std::string_view source;
   size_t parsing_index;
   size_t total_tokens;
+  // AST being built, handed to the caller by mainParser
+  Program program;
 
   // Parsing functions
   Instruction parsePrint();
-  Instruction parseTest();
+  Instruction parseTest(Instruction::Type inst_type);
+  Instruction parseTestAll();
   Instruction parseVar();
 
   // Expression parsing functions
-  Exp* parseRhs();
-  Exp_p2* parseExp_p2();
-  Exp_p1* parseExp_p1();
+  NodeId parseRhs();
+  NodeId parseExp_p2();
+  NodeId parseExp_p1();
 
   // Helper functions
   int consumeToken();
-  std::vector<Instruction> generateErrorIV(int err_val);
+  TokenKind currentKind();
+  std::string currentText();
+  int parseRangeBound(char &bound);
+  int parseTestValue(std::string &test_value);
+  int parseFilePath(std::string &path);
+  Program generateErrorProgram(int err_val);
   Instruction generateErrorInstruction(int err_val);
 };
 
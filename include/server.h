@@ -0,0 +1,37 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "../include/driver.h"
+#include <cstdio>
+#include <string>
+
+/* Line that ends the response to each request, followed by the status */
+#define SERVER_DONE_MARKER "@@done "
+
+// -----------------------------------------------------------------------------
+// Server Class
+// -----------------------------------------------------------------------------
+// The Server class keeps the transpiler resident and runs the scripts that
+// clients send, one at a time, through a single Driver so its caches stay
+// warm. Requests are read one per line:
+//   run <path>       Run the script in a file.
+//   source <bytes>   Run the script in the next <bytes> bytes.
+//   quit             Stop the server.
+// The script's output is followed by a SERVER_DONE_MARKER line.
+class Server {
+public:
+  explicit Server(Driver &script_driver);
+
+  // Serve requests from stdin until it ends or a client quits
+  int serveStdin();
+  // Serve connections to a Unix socket until a client quits
+  int serveSocket(const std::string &socket_path);
+
+private:
+  Driver &driver;
+
+  bool serveRequests(FILE *requests);
+  int runRequest(const std::string &request, FILE *requests);
+};
+
+#endif /* SERVER_H */
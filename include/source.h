@@ -0,0 +1,34 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <string>
+#include <string_view>
+
+// -----------------------------------------------------------------------------
+// SourceFile Class
+// -----------------------------------------------------------------------------
+// The SourceFile class maps a script into memory read-only, so the tokenizer
+// and parser work on the file's pages directly instead of on a copy. Inputs
+// that cannot be mapped, such as pipes, are read into a buffer instead.
+class SourceFile {
+public:
+  explicit SourceFile(const std::string &path);
+  ~SourceFile();
+
+  SourceFile(const SourceFile &) = delete;
+  SourceFile &operator=(const SourceFile &) = delete;
+
+  bool isOpen() const { return opened; }
+  // Contents of the file, valid for the lifetime of the SourceFile
+  std::string_view text() const { return std::string_view(data, size); }
+
+private:
+  const char *data;
+  size_t size;
+  bool mapped;
+  bool opened;
+  // Contents of inputs that could not be mapped
+  std::string buffer;
+};
+
+#endif /* SOURCE_H */
@@ -1,11 +1,18 @@
-#include "../include/nfa.h"
-#include "../include/regex.h"
+#ifndef TOKENIZE_H
+#define TOKENIZE_H
+
+#include "../include/transpiler_types.h"
+#include "../lib/frozen.h"
+#include "../lib/regex.h"
 #include <fstream>
 #include <iostream>
+#include <string_view>
 #include <vector>
 
-Node *initNFA();
-std::string outputToken(const std::string &lexeme);
-void makeLiteralNFAs(std::vector<std::pair<Node *, Node *>> &nfas);
-std::string removeComments(std::string input);
-std::vector<std::string> mainTokenizer(std::string input);
+FrozenNFA initNFA();
+std::string_view tokenName(TokenKind kind);
+std::string outputToken(const Token &token, std::string_view source);
+void makeLiteralNFAs(std::vector<NfaHandle> &nfas);
+std::vector<Token> mainTokenizer(std::string_view source);
+
+#endif /* TOKENIZE_H */
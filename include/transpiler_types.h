@@ -1,13 +1,58 @@
 #ifndef TRANSPILER_TYPES_H
 #define TRANSPILER_TYPES_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <variant>
 #include <vector>
 
 /* Macro Definitions */
 #define NO_ERR -1
 
+/* Token kinds, numbered like the token ids of the lexer's rules */
+enum class TokenKind : uint8_t {
+  End,
+  Quotation,
+  Semicolon,
+  Or,
+  Assign,
+  Star,
+  Plus,
+  Karet,
+  Question,
+  Dash,
+  OpenParen,
+  CloseParen,
+  Comma,
+  Dot,
+  Slash,
+  Test,
+  TestAll,
+  Search,
+  FindAll,
+  TestFile,
+  Print,
+  Colon,
+  Runner,
+  Num,
+  Id,
+  Ignore,
+  Error
+};
+
+/* A token is a span of the source text it was scanned from */
+struct Token {
+  TokenKind kind;
+  uint32_t offset;
+  uint32_t length;
+};
+
+/* Index of an expression node in its Program pool */
+typedef uint32_t NodeId;
+#define NO_NODE UINT32_MAX
+
 /* Forward declarations of types */
 struct Exp;
 struct Exp_p2;
@@ -15,26 +60,28 @@ struct Exp_p1;
 struct PrintData;
 struct AssignData;
 struct TestData;
+struct TestAllData;
 struct Instruction;
+struct Program;
 
 /* Structures */
 struct Exp {
-  Exp_p2 *exp_p2;
-  std::vector<std::pair<std::string, Exp_p2 *>> binop_exp_p2s;
+  NodeId exp_p2;
+  std::vector<std::pair<std::string, NodeId>> binop_exp_p2s;
 
-  Exp() : exp_p2(nullptr) {};
-  Exp(Exp_p2 *p2_exp) : exp_p2(p2_exp) {};
+  Exp() : exp_p2(NO_NODE) {};
+  Exp(NodeId p2_exp) : exp_p2(p2_exp) {};
 };
 
 struct Exp_p2 {
-  Exp_p1 *exp_p1;
+  NodeId exp_p1;
   enum class Type { None, KleeneStar, PosClos, Opt } unop_type;
 
   // "Default" constructor
-  Exp_p2(Exp_p1 *p1_exp) : exp_p1(p1_exp), unop_type(Type::None) {};
+  Exp_p2(NodeId p1_exp) : exp_p1(p1_exp), unop_type(Type::None) {};
 
   // Optional unop type is defined
-  Exp_p2(Exp_p1 *p1_exp, Type type_unop)
+  Exp_p2(NodeId p1_exp, Type type_unop)
       : exp_p1(p1_exp), unop_type(type_unop) {};
 };
 
@@ -42,36 +89,50 @@ struct Exp_p1 {
   // Exp: New expression
   // Exp_ac: Literal (string)
   // Lval: NFA (pre-existing)
-  enum class Type { Exp, Exp_ac, Lval } exp_p1_type;
+  // Range: Any single character between two bounds, e.g. (a-z)
+  enum class Type { Exp, Exp_ac, Lval, Range } exp_p1_type;
 
   // `(` exp `)`
-  Exp *exp;
+  NodeId exp;
   // exp_ac*
-  // (a-z)
   std::string identifier;
+  // (a-z)
+  char range_low;
+  char range_high;
 
-  Exp_p1() : exp(nullptr) {};
+  Exp_p1() : exp(NO_NODE), range_low(0), range_high(0) {};
 };
 
 struct PrintData {
   std::string output_string;
 
-  PrintData(std::string str) : output_string(str) {};
+  PrintData(std::string str) : output_string(std::move(str)) {};
 };
 
+// Also used by Search, FindAll and TestFile, which take the same operands.
+// For TestFile the test value is the path of the file to match.
 struct TestData {
   std::string NFA_name;
   std::string test_value;
 
   TestData(std::string name, std::string value)
-      : NFA_name(name), test_value(value) {};
+      : NFA_name(std::move(name)), test_value(std::move(value)) {};
+};
+
+struct TestAllData {
+  std::vector<std::string> NFA_names;
+  std::string test_value;
+
+  TestAllData(std::vector<std::string> names, std::string value)
+      : NFA_names(std::move(names)), test_value(std::move(value)) {};
 };
 
 struct AssignData {
   std::string lhs;
-  Exp *rhs;
+  NodeId rhs; // Index into Program::exps
 
-  AssignData(std::string left, Exp *right) : lhs(left), rhs(right) {};
+  AssignData(std::string left, NodeId right)
+      : lhs(std::move(left)), rhs(right) {};
 };
 
 struct ErrorData {
@@ -83,11 +144,49 @@ struct ErrorData {
 };
 
 struct Instruction {
-  enum class Type { Print, Test, Assign, Error } inst_type;
-  void *data;
+  enum class Type {
+    Print,
+    Test,
+    TestAll,
+    Search,
+    FindAll,
+    TestFile,
+    Assign,
+    Error
+  } inst_type;
+  // Test, Search, FindAll and TestFile hold TestData, the others their own
+  // type
+  std::variant<PrintData, TestData, TestAllData, AssignData, ErrorData> data;
 
   // Constructors
-  Instruction(Type type, void *ptr) : inst_type(type), data(ptr) {};
+  template <typename Data>
+  Instruction(Type type, Data payload)
+      : inst_type(type), data(std::move(payload)) {};
+};
+
+/*
+ * The AST of a script. Each kind of expression node is stored in its own
+ * pool and nodes refer to their children by index, so the whole tree is a
+ * handful of allocations and is freed along with the Program.
+ */
+struct Program {
+  std::vector<Instruction> instructions;
+  std::vector<Exp> exps;
+  std::vector<Exp_p2> exp_p2s;
+  std::vector<Exp_p1> exp_p1s;
+
+  NodeId addExp(Exp exp) {
+    exps.push_back(std::move(exp));
+    return exps.size() - 1;
+  }
+  NodeId addExp_p2(Exp_p2 exp_p2) {
+    exp_p2s.push_back(std::move(exp_p2));
+    return exp_p2s.size() - 1;
+  }
+  NodeId addExp_p1(Exp_p1 exp_p1) {
+    exp_p1s.push_back(std::move(exp_p1));
+    return exp_p1s.size() - 1;
+  }
 };
 
 #endif /* TRANSPILER_TYPES_H */
@@ -15,14 +15,15 @@
 // used to ensure proper programs are being fed by the user.
 class Validator {
 public:
-  explicit Validator(const std::vector<Instruction> instructions);
+  explicit Validator(const Program &parsed_program);
 
   // Main function
   int validate();
 
 private:
   std::unordered_set<std::string> variables;
-  std::vector<Instruction> instructions;
+  // Checked in place; the program outlives the validator
+  const std::vector<Instruction> &instructions;
 };
 
 #endif /* VALIDATE_H */
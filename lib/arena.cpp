@@ -0,0 +1,52 @@
+#include "arena.h"
+
+/*
+ * Function: NfaArena::absorb
+ *
+ *  Keep the chunks of another arena alive for as long as this one. Used when
+ *  two automata are combined into one graph. Costs one step per chunk of
+ *  other; this arena keeps allocating from its own current chunks.
+ *
+ *  @param other Arena whose nodes are now reachable from this arena's graph
+ */
+void NfaArena::absorb(const NfaArena &other) {
+  if (&other == this) {
+    return;
+  }
+  nodes.append(other.nodes);
+  classes.append(other.classes);
+}
+
+/*
+ * Function: NfaArena::chunkCount
+ *
+ *  @return Number of node and class chunks this arena keeps alive
+ */
+size_t NfaArena::chunkCount() const {
+  return nodes.chunkCount() + classes.chunkCount();
+}
+
+/*
+ * Function: MergeArenas
+ *
+ *  Arena for an automaton built from two others. If both already share an
+ *  arena it is reused; otherwise the arena holding more chunks takes over
+ *  the chunks of the other, so repeated merges do not copy the growing side.
+ *
+ *  @param nfa1 First automaton
+ *  @param nfa2 Second automaton
+ *
+ *  @return Arena owning the nodes of both automata
+ */
+std::shared_ptr<NfaArena> MergeArenas(const NfaHandle &nfa1,
+                                      const NfaHandle &nfa2) {
+  if (nfa1.arena == nfa2.arena) {
+    return nfa1.arena;
+  }
+  if (nfa1.arena->chunkCount() < nfa2.arena->chunkCount()) {
+    nfa2.arena->absorb(*nfa1.arena);
+    return nfa2.arena;
+  }
+  nfa1.arena->absorb(*nfa2.arena);
+  return nfa1.arena;
+}
@@ -0,0 +1,153 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "nfa.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/* Capacity of the first chunk an arena allocates; later chunks double */
+#define NFA_ARENA_FIRST_CHUNK 16
+#define NFA_ARENA_MAX_CHUNK 4096
+
+/*
+ * class: NfaChunk
+ *
+ * One contiguous block of storage for nodes or character classes. Items are
+ * constructed in place, one after another, and all destroyed together with
+ * the chunk.
+ *
+ */
+template <typename T> class NfaChunk {
+public:
+  explicit NfaChunk(size_t capacity)
+      : storage(static_cast<T *>(::operator new(capacity * sizeof(T)))),
+        capacity(capacity), used(0) {}
+  ~NfaChunk() {
+    for (size_t i = 0; i < used; i++) {
+      storage[i].~T();
+    }
+    ::operator delete(storage);
+  }
+  NfaChunk(const NfaChunk &) = delete;
+  NfaChunk &operator=(const NfaChunk &) = delete;
+
+  bool full() const { return used == capacity; }
+  size_t size() const { return used; }
+  template <typename... Args> T *construct(Args &&...args) {
+    return new (storage + used++) T(std::forward<Args>(args)...);
+  }
+
+private:
+  T *storage;
+  size_t capacity;
+  size_t used;
+};
+
+/*
+ * class: NfaChunkList
+ *
+ * The chunks of one kind of item an arena keeps alive. Items are
+ * bump-allocated from the chunk this list started last; chunks taken over
+ * from another list are only kept alive, never allocated from.
+ *
+ */
+template <typename T> class NfaChunkList {
+public:
+  NfaChunkList() : nextChunkSize(NFA_ARENA_FIRST_CHUNK) {}
+
+  template <typename... Args> T *construct(Args &&...args) {
+    if (current == nullptr || current->full()) {
+      current = std::make_shared<NfaChunk<T>>(nextChunkSize);
+      chunks.push_back(current);
+      owned.insert(current.get());
+      nextChunkSize =
+          std::min<size_t>(nextChunkSize * 2, NFA_ARENA_MAX_CHUNK);
+    }
+    return current->construct(std::forward<Args>(args)...);
+  }
+
+  // Keep the chunks of other alive too, skipping those already held
+  void append(const NfaChunkList &other) {
+    for (const auto &chunk : other.chunks) {
+      if (owned.insert(chunk.get()).second) {
+        chunks.push_back(chunk);
+      }
+    }
+  }
+
+  size_t chunkCount() const { return chunks.size(); }
+  size_t itemCount() const {
+    size_t count = 0;
+    for (const auto &chunk : chunks) {
+      count += chunk->size();
+    }
+    return count;
+  }
+
+private:
+  std::vector<std::shared_ptr<NfaChunk<T>>> chunks;
+  std::unordered_set<const NfaChunk<T> *> owned;
+  std::shared_ptr<NfaChunk<T>> current;
+  size_t nextChunkSize;
+};
+
+/*
+ * class: NfaArena
+ *
+ * Owns every node and character class of an automaton. Both are
+ * bump-allocated from chunks and released in bulk when the last arena holding
+ * a chunk goes away. Combining two automata (ConcatNFA, ThompsonNFA, ...)
+ * hands the result the arena of the larger input, which takes over the
+ * chunks of the smaller one, so a graph never outlives its storage and
+ * building an expression of n parts costs O(n log n) chunk bookkeeping.
+ *
+ */
+class NfaArena {
+public:
+  NfaArena() = default;
+  NfaArena(const NfaArena &) = delete;
+  NfaArena &operator=(const NfaArena &) = delete;
+
+  Node *newNode() { return nodes.construct(); }
+  const CharClass *newCharClass(const CharClass &charClass) {
+    return classes.construct(charClass);
+  }
+  void absorb(const NfaArena &other);
+  size_t chunkCount() const;
+  size_t nodeCount() const { return nodes.itemCount(); }
+
+private:
+  NfaChunkList<Node> nodes;
+  // Classes referenced by CLASS labels of the nodes above
+  NfaChunkList<CharClass> classes;
+};
+
+/*
+ * struct: NfaHandle
+ *
+ * Owning reference to an automaton: its start and accepting node plus the
+ * arena holding them. Copies share the arena; the nodes are freed when the
+ * last handle (or arena sharing its chunks) is destroyed, e.g. when a
+ * variable of a generated program is reassigned.
+ *
+ * @field arena: Arena owning the nodes.
+ * @field start: Start node of the automaton.
+ * @field accept: Accepting node, or nullptr for unions built by ThompsonNFA.
+ *
+ */
+struct NfaHandle {
+  std::shared_ptr<NfaArena> arena;
+  Node *start;
+  Node *accept;
+};
+
+/* Function Prototypes */
+std::shared_ptr<NfaArena> MergeArenas(const NfaHandle &nfa1,
+                                      const NfaHandle &nfa2);
+
+#endif /* ARENA_H */
@@ -0,0 +1,20 @@
+#ifndef AUTOMATA_H
+#define AUTOMATA_H
+
+/*
+ * Everything a generated program can use from the runtime library, in one
+ * header so that it can be precompiled once (make runtime) instead of being
+ * parsed again for every script.
+ */
+
+#include "bitnfa.h"
+#include "dfa.h"
+#include "patternset.h"
+#include "regex.h"
+#include "search.h"
+#include "stream.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+#endif /* AUTOMATA_H */
@@ -0,0 +1,222 @@
+#include "batch.h"
+#include <algorithm>
+
+/*
+ * Function: BatchResult::acceptedCount
+ *
+ *  @return Number of accepted inputs
+ */
+size_t BatchResult::acceptedCount() const {
+  size_t count = 0;
+  for (uint64_t word : accepted) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+/*
+ * Function: BatchMatcher::BatchMatcher
+ *
+ *  Start the worker threads. They sleep until a batch arrives.
+ *
+ *  @param numThreads Number of threads, 0 for one per hardware thread
+ */
+BatchMatcher::BatchMatcher(int numThreads)
+    : generation(0), busyWorkers(0), stopping(false), stealCount(0) {
+  if (numThreads <= 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int worker = 0; worker < numThreads; worker++) {
+    queues.emplace_back(new TaskQueue());
+  }
+  for (int worker = 0; worker < numThreads; worker++) {
+    workers.emplace_back(&BatchMatcher::workerLoop, this, worker);
+  }
+}
+
+/*
+ * Function: BatchMatcher::~BatchMatcher
+ *
+ *  Stop and join the worker threads.
+ */
+BatchMatcher::~BatchMatcher() {
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+    stopping = true;
+  }
+  jobReady.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+/*
+ * Function: BatchMatcher::nextTask
+ *
+ *  Take the next task for a worker: the back of its own queue, or else the
+ *  front of the first other queue that still has work.
+ *
+ *  @param worker Index of the worker
+ *  @param task Receives the task
+ *
+ *  @return FALSE once every queue is empty
+ */
+bool BatchMatcher::nextTask(int worker, std::pair<size_t, size_t> &task) {
+  {
+    TaskQueue &own = *queues[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.tasks.empty()) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  int numQueues = queues.size();
+  for (int offset = 1; offset < numQueues; offset++) {
+    TaskQueue &victim = *queues[(worker + offset) % numQueues];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      stealCount++;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Function: BatchMatcher::workerLoop
+ *
+ *  Body of a worker thread: wait for a batch, run tasks until none are left,
+ *  report back and wait again.
+ *
+ *  @param worker Index of the worker
+ */
+void BatchMatcher::workerLoop(int worker) {
+  size_t seenGeneration = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(jobLock);
+      jobReady.wait(guard,
+                    [&] { return stopping || generation != seenGeneration; });
+      if (stopping) {
+        return;
+      }
+      seenGeneration = generation;
+    }
+
+    std::pair<size_t, size_t> task;
+    while (nextTask(worker, task)) {
+      body(worker, task.first, task.second);
+    }
+
+    std::lock_guard<std::mutex> guard(jobLock);
+    if (--busyWorkers == 0) {
+      jobDone.notify_all();
+    }
+  }
+}
+
+/*
+ * Function: BatchMatcher::runTasks
+ *
+ *  Cut [0, count) into tasks, deal each worker a contiguous share and wait
+ *  until all of them are done.
+ *
+ *  @param count Number of inputs
+ *  @param taskBody Called with (worker, first, last) for every task
+ */
+void BatchMatcher::runTasks(size_t count, TaskBody taskBody) {
+  size_t numTasks = (count + BATCH_TASK_SIZE - 1) / BATCH_TASK_SIZE;
+  size_t numWorkers = workers.size();
+  for (size_t worker = 0; worker < numWorkers; worker++) {
+    size_t firstTask = numTasks * worker / numWorkers;
+    size_t lastTask = numTasks * (worker + 1) / numWorkers;
+    for (size_t t = firstTask; t < lastTask; t++) {
+      queues[worker]->tasks.push_back(
+          {t * BATCH_TASK_SIZE, std::min(count, (t + 1) * BATCH_TASK_SIZE)});
+    }
+  }
+
+  std::unique_lock<std::mutex> guard(jobLock);
+  body = std::move(taskBody);
+  busyWorkers = numWorkers;
+  generation++;
+  jobReady.notify_all();
+  jobDone.wait(guard, [&] { return busyWorkers == 0; });
+}
+
+/*
+ * Function: SetAccepted
+ *
+ *  Fill in the bitmap words of one task from its lengths. Tasks start at
+ *  multiples of 64, so no two tasks share a word.
+ *
+ *  @param result The batch result
+ *  @param first First input of the task
+ *  @param last One past the last input of the task
+ */
+static void SetAccepted(BatchResult &result, size_t first, size_t last) {
+  for (size_t index = first; index < last; index++) {
+    if (result.lengths[index] >= 0) {
+      result.accepted[index / 64] |= 1ULL << (index % 64);
+    }
+  }
+}
+
+/*
+ * Function: BatchMatcher::match
+ *
+ *  Full-match every input against a frozen NFA. Every worker has its own
+ *  MatchScratch, so the threads share nothing but the automaton.
+ *
+ *  @param nfa The automaton
+ *  @param inputs First of count inputs
+ *  @param count Number of inputs
+ *
+ *  @return Lengths and accept bitmap of every input
+ */
+BatchResult BatchMatcher::match(const FrozenNFA &nfa,
+                                const std::string *inputs, size_t count) {
+  BatchResult result;
+  result.lengths.resize(count);
+  result.accepted.assign((count + 63) / 64, 0);
+  std::vector<MatchScratch> scratch(workers.size(), MatchScratch(nfa));
+
+  runTasks(count, [&](int worker, size_t first, size_t last) {
+    for (size_t index = first; index < last; index++) {
+      result.lengths[index] =
+          MatchNFA(nfa, inputs[index], scratch[worker]).length;
+    }
+    SetAccepted(result, first, last);
+  });
+  return result;
+}
+
+/*
+ * Function: BatchMatcher::match
+ *
+ *  Full-match every input against a compiled DFA.
+ *
+ *  @param dfa The automaton
+ *  @param inputs First of count inputs
+ *  @param count Number of inputs
+ *
+ *  @return Lengths and accept bitmap of every input
+ */
+BatchResult BatchMatcher::match(const DFA &dfa, const std::string *inputs,
+                                size_t count) {
+  BatchResult result;
+  result.lengths.resize(count);
+  result.accepted.assign((count + 63) / 64, 0);
+
+  runTasks(count, [&](int worker, size_t first, size_t last) {
+    for (size_t index = first; index < last; index++) {
+      result.lengths[index] = RunDFA(dfa, 0, inputs[index]);
+    }
+    SetAccepted(result, first, last);
+  });
+  return result;
+}
@@ -0,0 +1,98 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "dfa.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Inputs per task; a multiple of 64 so a task owns whole bitmap words */
+#define BATCH_TASK_SIZE 256
+
+/*
+ * struct: BatchResult
+ *
+ * Outcome of matching many inputs against one automaton.
+ *
+ * @field lengths: Matched length of every input, -1 where it was rejected.
+ * @field accepted: Bitmap of accepted inputs, bit i % 64 of word i / 64.
+ *
+ */
+struct BatchResult {
+  std::vector<int> lengths;
+  std::vector<uint64_t> accepted;
+
+  bool isAccepted(size_t index) const {
+    return (accepted[index / 64] >> (index % 64)) & 1;
+  }
+  size_t acceptedCount() const;
+};
+
+/*
+ * class: BatchMatcher
+ *
+ * Thread pool that matches a batch of inputs against one automaton. The
+ * automaton is shared read-only by every thread; each thread has its own
+ * scratch space. The batch is cut into tasks of BATCH_TASK_SIZE inputs and
+ * every thread starts with a contiguous share of them in its own queue. A
+ * thread that runs out of work steals from the front of another thread's
+ * queue, so uneven input lengths do not leave threads idle. One batch runs
+ * at a time.
+ *
+ */
+class BatchMatcher {
+public:
+  explicit BatchMatcher(int numThreads = 0);
+  ~BatchMatcher();
+
+  BatchMatcher(const BatchMatcher &) = delete;
+  BatchMatcher &operator=(const BatchMatcher &) = delete;
+
+  BatchResult match(const FrozenNFA &nfa, const std::string *inputs,
+                    size_t count);
+  BatchResult match(const DFA &dfa, const std::string *inputs, size_t count);
+  BatchResult match(const FrozenNFA &nfa,
+                    const std::vector<std::string> &inputs) {
+    return match(nfa, inputs.data(), inputs.size());
+  }
+  BatchResult match(const DFA &dfa, const std::vector<std::string> &inputs) {
+    return match(dfa, inputs.data(), inputs.size());
+  }
+
+  int numThreads() const { return workers.size(); }
+  size_t stolenTasks() const { return stealCount; }
+
+private:
+  typedef std::function<void(int, size_t, size_t)> TaskBody;
+
+  // Tasks are [first, last) ranges of input indices
+  struct TaskQueue {
+    std::mutex lock;
+    std::deque<std::pair<size_t, size_t>> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<TaskQueue>> queues;
+
+  std::mutex jobLock;
+  std::condition_variable jobReady;
+  std::condition_variable jobDone;
+  TaskBody body;
+  size_t generation;
+  int busyWorkers;
+  bool stopping;
+  std::atomic<size_t> stealCount;
+
+  void workerLoop(int worker);
+  bool nextTask(int worker, std::pair<size_t, size_t> &task);
+  void runTasks(size_t count, TaskBody taskBody);
+};
+
+#endif /* BATCH_H */
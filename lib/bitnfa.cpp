@@ -0,0 +1,117 @@
+#include "bitnfa.h"
+#include <cstring>
+
+/*
+ * Function: CompileBitNFA
+ *
+ *  Build the position automaton of a frozen NFA. The positions leaving a
+ *  state are its character and class edges; the follow set of a position is
+ *  every position leaving the epsilon closure of its target, and the
+ *  position is accepting if that closure holds a terminal state. The start
+ *  position works the same way with the start state as its target.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The bit-parallel automaton, with usable unset if the NFA has more
+ *  than BITNFA_MAX_POSITIONS - 1 transitions
+ */
+BitNFA CompileBitNFA(const FrozenNFA &nfa) {
+  BitNFA bits;
+  memset(&bits, 0, sizeof(bits));
+
+  // Number the positions; leaving[s] holds the positions that leave state s
+  int numPositions = 1;
+  std::vector<uint64_t> leaving(nfa.numStates(), 0);
+  std::vector<uint32_t> targets = {nfa.startState};
+  for (uint32_t state = 0; state < nfa.numStates(); state++) {
+    int numEdges = nfa.edgeOffsets[state + 1] - nfa.edgeOffsets[state] +
+                   nfa.classEdgeOffsets[state + 1] -
+                   nfa.classEdgeOffsets[state];
+    if (numPositions + numEdges > BITNFA_MAX_POSITIONS) {
+      return bits;
+    }
+
+    for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+         i++) {
+      bits.byteMasks[nfa.edges[i].symbol] |= 1ULL << numPositions;
+      leaving[state] |= 1ULL << numPositions;
+      targets.push_back(nfa.edges[i].target);
+      numPositions++;
+    }
+    for (uint32_t i = nfa.classEdgeOffsets[state];
+         i < nfa.classEdgeOffsets[state + 1]; i++) {
+      const CharClass &charClass = nfa.classes[nfa.classEdges[i].classId];
+      for (int byte = 0; byte < 256; byte++) {
+        if (charClass.contains(byte)) {
+          bits.byteMasks[byte] |= 1ULL << numPositions;
+        }
+      }
+      leaving[state] |= 1ULL << numPositions;
+      targets.push_back(nfa.classEdges[i].target);
+      numPositions++;
+    }
+  }
+
+  // Follow set and acceptance of every position
+  std::vector<uint64_t> follow(numPositions, 0);
+  SparseSet closure(nfa.numStates());
+  std::vector<uint32_t> stack;
+  for (int position = 0; position < numPositions; position++) {
+    closure.clear();
+    AddFrozenState(nfa, closure, targets[position], stack);
+    for (uint32_t state : closure) {
+      follow[position] |= leaving[state];
+      if (nfa.isTerminal[state]) {
+        bits.accepting |= 1ULL << position;
+      }
+    }
+  }
+
+  bits.usable = true;
+  bits.numPositions = numPositions;
+  bits.numChunks =
+      (numPositions + BITNFA_CHUNK_BITS - 1) / BITNFA_CHUNK_BITS;
+  for (int chunk = 0; chunk < bits.numChunks; chunk++) {
+    for (int value = 1; value < (1 << BITNFA_CHUNK_BITS); value++) {
+      // Extend the table entry without the lowest bit by that bit's follow
+      int lowest = __builtin_ctz(value);
+      int position = chunk * BITNFA_CHUNK_BITS + lowest;
+      uint64_t lowestFollow = position < numPositions ? follow[position] : 0;
+      bits.follow[chunk][value] =
+          bits.follow[chunk][value & (value - 1)] | lowestFollow;
+    }
+  }
+  return bits;
+}
+
+/*
+ * Function: RunBitNFA
+ *  Alternative to RunNFA for automata with few transitions: the active
+ *  positions are kept in one word and stepped with table lookups, so the
+ *  match allocates nothing.
+ *
+ * @param nfa
+ * @param startIndex
+ * @param input
+ *
+ * @return -1 if terminal not found.
+ */
+int RunBitNFA(const BitNFA &nfa, int startIndex, std::string_view input) {
+  uint64_t active = 1;
+  for (size_t index = startIndex; index < input.size(); index++) {
+    uint64_t reachable = 0;
+    for (int chunk = 0; chunk < nfa.numChunks; chunk++) {
+      reachable |= nfa.follow[chunk][(active >> (chunk * BITNFA_CHUNK_BITS)) &
+                                     ((1 << BITNFA_CHUNK_BITS) - 1)];
+    }
+    active = reachable & nfa.byteMasks[(unsigned char)input[index]];
+    if (active == 0) {
+      return -1;
+    }
+  }
+
+  if ((active & nfa.accepting) == 0) {
+    return -1;
+  }
+  return input.size() - startIndex;
+}
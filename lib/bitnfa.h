@@ -0,0 +1,52 @@
+#ifndef BITNFA_H
+#define BITNFA_H
+
+#include "frozen.h"
+#include <cstdint>
+#include <string_view>
+
+/* Positions a BitNFA can hold, including the start position */
+#define BITNFA_MAX_POSITIONS 64
+
+/* Positions covered by one follow table */
+#define BITNFA_CHUNK_BITS 8
+#define BITNFA_CHUNKS (BITNFA_MAX_POSITIONS / BITNFA_CHUNK_BITS)
+
+/*
+ * struct: BitNFA
+ *
+ * Glushkov (position) automaton whose whole state set is one 64-bit word.
+ * Every character or class transition of the NFA is a position; bit 0 is
+ * the start position. A position is entered only on the bytes of its own
+ * transition, so one step is
+ *
+ *   active = follow(active) & byteMasks[byte]
+ *
+ * where follow(active) ORs the follow sets of the active positions. The
+ * follow sets are tabulated for every value of each 8-bit chunk of the word,
+ * so a step costs one lookup per chunk in use and never branches on states.
+ *
+ * @field usable: FALSE if the NFA has too many positions; nothing else is
+ * set then.
+ * @field numPositions: Positions including the start position.
+ * @field numChunks: Chunks of the state word that hold positions.
+ * @field byteMasks: Positions entered on each byte.
+ * @field follow: follow[k][v] is the union of the follow sets of the
+ * positions in bits 8k to 8k + 7 of v << 8k.
+ * @field accepting: Positions after which the input may end.
+ *
+ */
+struct BitNFA {
+  bool usable;
+  int numPositions;
+  int numChunks;
+  uint64_t byteMasks[256];
+  uint64_t follow[BITNFA_CHUNKS][1 << BITNFA_CHUNK_BITS];
+  uint64_t accepting;
+};
+
+/* Function Prototypes */
+BitNFA CompileBitNFA(const FrozenNFA &nfa);
+int RunBitNFA(const BitNFA &nfa, int startIndex, std::string_view input);
+
+#endif /* BITNFA_H */
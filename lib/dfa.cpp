@@ -0,0 +1,526 @@
+#include "dfa.h"
+#include <algorithm>
+
+/* A flush is wasted when fewer bytes than this per cached state were matched */
+#define DFA_MIN_BYTES_PER_STATE 10
+
+/*
+ * Function: SortedStates
+ *
+ *  Copy a state set into its canonical, sorted form.
+ *
+ *  @param stateSet The set to copy
+ *
+ *  @return The states of the set in ascending order
+ */
+static std::vector<uint32_t> SortedStates(const SparseSet &stateSet) {
+  std::vector<uint32_t> states(stateSet.begin(), stateSet.end());
+  std::sort(states.begin(), states.end());
+  return states;
+}
+
+/*
+ * Function: LazyDFA::LazyDFA
+ *
+ *  Set up an empty cache holding only the start state.
+ *
+ *  @param frozenNFA NFA to determinize; the DFA keeps its own copy
+ *  @param cacheBudget Memory the cached states may use, in bytes
+ */
+LazyDFA::LazyDFA(const FrozenNFA &frozenNFA, size_t cacheBudget)
+    : nfa(frozenNFA), cacheBudget(cacheBudget), cacheBytes(0), flushCount(0),
+      fallbackCount(0), bytesSinceFlush(0), wastedFlushes(0),
+      startState(DFA_UNKNOWN),
+      currentSet(frozenNFA.numStates()), nextSet(frozenNFA.numStates()) {
+  flushCache();
+  flushCount = 0;
+}
+
+/*
+ * Function: LazyDFA::addState
+ *
+ *  Look up the DFA state standing for a set of NFA states, creating it if
+ *  this set has not been seen since the last flush.
+ *
+ *  @param nfaStates Sorted set of NFA states
+ *
+ *  @return Index of the DFA state
+ */
+int LazyDFA::addState(std::vector<uint32_t> nfaStates) {
+  auto found = stateIds.find(nfaStates);
+  if (found != stateIds.end()) {
+    return found->second;
+  }
+
+  DFAState state;
+  state.isAccepting = false;
+  for (uint32_t nfaState : nfaStates) {
+    if (nfa.isTerminal[nfaState]) {
+      state.isAccepting = true;
+    }
+  }
+  state.transitions.assign(nfa.byteClasses.numClasses, DFA_UNKNOWN);
+
+  // The set is stored twice: once in the state, once as the map key
+  cacheBytes += sizeof(DFAState) + 2 * nfaStates.size() * sizeof(uint32_t) +
+                state.transitions.size() * sizeof(int);
+
+  int id = states.size();
+  stateIds.emplace(nfaStates, id);
+  state.nfaStates = std::move(nfaStates);
+  states.push_back(std::move(state));
+  return id;
+}
+
+/*
+ * Function: LazyDFA::computeTransition
+ *
+ *  Determinize one transition: step every NFA state of the DFA state over
+ *  a byte of the class and cache the resulting state for the whole class.
+ *
+ *  @param state Index of the DFA state to leave
+ *  @param byteClass Byte class of the input byte
+ *
+ *  @return Index of the target DFA state
+ */
+int LazyDFA::computeTransition(int state, int byteClass) {
+  currentSet.clear();
+  for (uint32_t nfaState : states[state].nfaStates) {
+    currentSet.insert(nfaState);
+  }
+  nextSet.clear();
+  StepFrozenStates(nfa, currentSet, nfa.byteClasses.representatives[byteClass],
+                   nextSet, stack);
+
+  int target = addState(SortedStates(nextSet));
+  states[state].transitions[byteClass] = target;
+  return target;
+}
+
+/*
+ * Function: LazyDFA::flushCache
+ *
+ *  Drop every cached state, leaving only the start state.
+ */
+void LazyDFA::flushCache() {
+  states.clear();
+  stateIds.clear();
+  cacheBytes = 0;
+  flushCount++;
+
+  currentSet.clear();
+  AddFrozenState(nfa, currentSet, nfa.startState, stack);
+  startState = addState(SortedStates(currentSet));
+}
+
+/*
+ * Function: LazyDFA::finishWithNFA
+ *
+ *  Match the rest of the input with NFA simulation, starting from a set of
+ *  active NFA states. Used once the cache is thrashing.
+ *
+ *  @param nfaStates States active at index
+ *  @param index Position of the next input byte
+ *  @param input The input string
+ *
+ *  @return TRUE if a terminal state is active at the end of the input
+ */
+bool LazyDFA::finishWithNFA(const std::vector<uint32_t> &nfaStates, int index,
+                            std::string_view input) {
+  currentSet.clear();
+  for (uint32_t nfaState : nfaStates) {
+    currentSet.insert(nfaState);
+  }
+
+  while (index < (int)input.size() && !currentSet.empty()) {
+    nextSet.clear();
+    StepFrozenStates(nfa, currentSet, input[index], nextSet, stack);
+    std::swap(currentSet, nextSet);
+    index++;
+  }
+
+  if (index != (int)input.size()) {
+    return false;
+  }
+  for (uint32_t nfaState : currentSet) {
+    if (nfa.isTerminal[nfaState]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Function: LazyDFA::startMatch
+ *
+ *  Begin a new match and reset the thrash detection.
+ *
+ *  @return The start state
+ */
+int LazyDFA::startMatch() {
+  bytesSinceFlush = 0;
+  wastedFlushes = 0;
+  return startState;
+}
+
+/*
+ * Function: LazyDFA::advance
+ *
+ *  Follow one transition, determinizing it first if it is not cached. A
+ *  flush counts as wasted when fewer than DFA_MIN_BYTES_PER_STATE bytes per
+ *  cached state were matched since the previous one; after DFA_THRASH_LIMIT
+ *  wasted flushes the DFA gives up and the caller has to continue with NFA
+ *  simulation from nfaStatesOf(state).
+ *
+ *  @param state Current state
+ *  @param symbol Input byte
+ *
+ *  @return The next state, or DFA_UNKNOWN if the cache is thrashing
+ */
+int LazyDFA::advance(int state, unsigned char symbol) {
+  int byteClass = nfa.byteClasses.map[symbol];
+  int next = states[state].transitions[byteClass];
+
+  if (next == DFA_UNKNOWN) {
+    if (cacheBytes > cacheBudget) {
+      if (bytesSinceFlush < DFA_MIN_BYTES_PER_STATE * states.size()) {
+        wastedFlushes++;
+      }
+      if (wastedFlushes >= DFA_THRASH_LIMIT) {
+        fallbackCount++;
+        return DFA_UNKNOWN;
+      }
+
+      // Keep the current state alive across the flush
+      std::vector<uint32_t> current = states[state].nfaStates;
+      flushCache();
+      state = addState(std::move(current));
+      bytesSinceFlush = 0;
+    }
+    next = computeTransition(state, byteClass);
+  }
+
+  bytesSinceFlush++;
+  return next;
+}
+
+/*
+ * Function: LazyDFA::run
+ *
+ *  Run the input through the DFA, determinizing states as they are first
+ *  reached. If the cache starts thrashing the rest of the input is matched
+ *  with NFA simulation instead.
+ *
+ *  @param startIndex Index of the first input byte to match
+ *  @param input The input string
+ *
+ *  @return Matched length if the whole input is accepted, -1 otherwise
+ */
+int LazyDFA::run(int startIndex, std::string_view input) {
+  int state = startMatch();
+
+  for (int index = startIndex; index < (int)input.size(); index++) {
+    int next = advance(state, input[index]);
+    if (next == DFA_UNKNOWN) {
+      if (!finishWithNFA(states[state].nfaStates, index, input)) {
+        return -1;
+      }
+      return input.size() - startIndex;
+    }
+
+    state = next;
+
+    // Dead state, nothing can accept any more
+    if (states[state].nfaStates.empty()) {
+      return -1;
+    }
+  }
+
+  if (!states[state].isAccepting) {
+    return -1;
+  }
+  return input.size() - startIndex;
+}
+
+/*
+ * Function: RunLazyDFA
+ *  Alternative to RunNFA that matches with a lazily built DFA. The DFA keeps
+ *  its cache between calls, so repeated runs over the same automaton get
+ *  faster as more states are determinized.
+ *
+ * @param dfa
+ * @param startIndex
+ * @param input
+ *
+ * @return -1 if terminal not found.
+ */
+int RunLazyDFA(LazyDFA &dfa, int startIndex, std::string_view input) {
+  return dfa.run(startIndex, input);
+}
+
+/*
+ * Function: DeterminizeNFA
+ *
+ *  Subset construction over every reachable set of NFA states. The empty set
+ *  becomes the dead state, so the resulting table is total. Each byte class
+ *  is stepped once, using its smallest byte.
+ *
+ *  @param nfa The frozen NFA
+ *
+ *  @return The determinized automaton
+ */
+DFA DeterminizeNFA(const FrozenNFA &nfa) {
+  DFA dfa;
+  std::map<std::vector<uint32_t>, int> stateIds;
+  std::vector<std::vector<uint32_t>> sets;
+  SparseSet currentSet(nfa.numStates());
+  SparseSet nextSet(nfa.numStates());
+  std::vector<uint32_t> stack;
+
+  AddFrozenState(nfa, currentSet, nfa.startState, stack);
+  sets.push_back(SortedStates(currentSet));
+  stateIds.emplace(sets[0], 0);
+  dfa.byteClasses = nfa.byteClasses;
+  dfa.startState = 0;
+  dfa.deadState = -1;
+
+  for (size_t state = 0; state < sets.size(); state++) {
+    bool isAccepting = false;
+    currentSet.clear();
+    for (uint32_t nfaState : sets[state]) {
+      currentSet.insert(nfaState);
+      if (nfa.isTerminal[nfaState]) {
+        isAccepting = true;
+      }
+    }
+    dfa.accepting.push_back(isAccepting);
+    if (sets[state].empty()) {
+      dfa.deadState = state;
+    }
+
+    for (int byteClass = 0; byteClass < dfa.numClasses(); byteClass++) {
+      nextSet.clear();
+      StepFrozenStates(nfa, currentSet,
+                       nfa.byteClasses.representatives[byteClass], nextSet,
+                       stack);
+      std::vector<uint32_t> next = SortedStates(nextSet);
+
+      int target;
+      auto found = stateIds.find(next);
+      if (found != stateIds.end()) {
+        target = found->second;
+      } else {
+        target = sets.size();
+        stateIds.emplace(next, target);
+        sets.push_back(std::move(next));
+      }
+      dfa.transitions.push_back(target);
+    }
+  }
+
+  return dfa;
+}
+
+/*
+ * Function: MinimizeDFA
+ *
+ *  Hopcroft's partition refinement. States start split into accepting and
+ *  rejecting blocks; a (block, byte class) splitter divides every block that
+ *  has some, but not all, of its states moving into the splitter on that
+ *  class. Only the smaller half of a split is queued unless the block was
+ *  already waiting, which bounds the work to O(k * n log n) for k byte
+ *  classes.
+ *
+ *  @param dfa Total DFA to minimize
+ *
+ *  @return Equivalent DFA with the fewest states
+ */
+DFA MinimizeDFA(const DFA &dfa) {
+  int numStates = dfa.numStates();
+  int numClasses = dfa.numClasses();
+
+  // Predecessors of state t on byte class c live in
+  // predecessors[offsets[c * numStates + t], offsets[c * numStates + t + 1])
+  std::vector<int> offsets(numClasses * numStates + 1, 0);
+  std::vector<int> predecessors(numClasses * numStates);
+  for (int state = 0; state < numStates; state++) {
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      offsets[byteClass * numStates + dfa.nextClass(state, byteClass) + 1]++;
+    }
+  }
+  for (size_t i = 1; i < offsets.size(); i++) {
+    offsets[i] += offsets[i - 1];
+  }
+  std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+  for (int state = 0; state < numStates; state++) {
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      int target = dfa.nextClass(state, byteClass);
+      predecessors[cursor[byteClass * numStates + target]++] = state;
+    }
+  }
+
+  // Blocks are ranges of elements; the first blockMarked[b] entries of a
+  // block are the states marked by the current splitter
+  std::vector<int> elements, location(numStates), blockOf(numStates);
+  std::vector<int> blockFirst, blockEnd, blockMarked;
+  for (int pass = 0; pass < 2; pass++) {
+    bool wantAccepting = pass == 0;
+    size_t first = elements.size();
+    for (int state = 0; state < numStates; state++) {
+      if (dfa.accepting[state] == wantAccepting) {
+        location[state] = elements.size();
+        blockOf[state] = blockFirst.size();
+        elements.push_back(state);
+      }
+    }
+    if (elements.size() != first) {
+      blockFirst.push_back(first);
+      blockEnd.push_back(elements.size());
+      blockMarked.push_back(0);
+    }
+  }
+
+  std::vector<std::pair<int, int>> worklist;
+  std::vector<char> inWorklist(blockFirst.size() * numClasses, 0);
+  if (blockFirst.size() == 2) {
+    int smaller =
+        blockEnd[0] - blockFirst[0] <= blockEnd[1] - blockFirst[1] ? 0 : 1;
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      worklist.push_back({smaller, byteClass});
+      inWorklist[smaller * numClasses + byteClass] = 1;
+    }
+  }
+
+  std::vector<int> marked, touched;
+  while (!worklist.empty()) {
+    int splitter = worklist.back().first;
+    int byteClass = worklist.back().second;
+    worklist.pop_back();
+    inWorklist[splitter * numClasses + byteClass] = 0;
+
+    marked.clear();
+    for (int i = blockFirst[splitter]; i < blockEnd[splitter]; i++) {
+      int target = elements[i];
+      for (int p = offsets[byteClass * numStates + target];
+           p < offsets[byteClass * numStates + target + 1]; p++) {
+        marked.push_back(predecessors[p]);
+      }
+    }
+
+    // Move every marked state to the front of its block
+    for (int state : marked) {
+      int block = blockOf[state];
+      int boundary = blockFirst[block] + blockMarked[block];
+      if (location[state] < boundary) {
+        continue;
+      }
+      int other = elements[boundary];
+      std::swap(elements[location[state]], elements[boundary]);
+      location[other] = location[state];
+      location[state] = boundary;
+      if (blockMarked[block] == 0) {
+        touched.push_back(block);
+      }
+      blockMarked[block]++;
+    }
+
+    for (int block : touched) {
+      int markedCount = blockMarked[block];
+      blockMarked[block] = 0;
+      if (markedCount == blockEnd[block] - blockFirst[block]) {
+        continue;
+      }
+
+      // The marked prefix becomes a new block
+      int newBlock = blockFirst.size();
+      blockFirst.push_back(blockFirst[block]);
+      blockEnd.push_back(blockFirst[block] + markedCount);
+      blockMarked.push_back(0);
+      blockFirst[block] += markedCount;
+      for (int i = blockFirst[newBlock]; i < blockEnd[newBlock]; i++) {
+        blockOf[elements[i]] = newBlock;
+      }
+      inWorklist.resize(blockFirst.size() * numClasses, 0);
+
+      bool newIsSmaller = markedCount <= blockEnd[block] - blockFirst[block];
+      for (int c = 0; c < numClasses; c++) {
+        int queued = newBlock;
+        if (!inWorklist[block * numClasses + c] && !newIsSmaller) {
+          queued = block;
+        }
+        if (!inWorklist[queued * numClasses + c]) {
+          worklist.push_back({queued, c});
+          inWorklist[queued * numClasses + c] = 1;
+        }
+      }
+    }
+    touched.clear();
+  }
+
+  // One state per block, using the first element as representative
+  DFA minimized;
+  int numBlocks = blockFirst.size();
+  minimized.byteClasses = dfa.byteClasses;
+  minimized.transitions.resize(numBlocks * numClasses);
+  minimized.accepting.resize(numBlocks);
+  for (int block = 0; block < numBlocks; block++) {
+    int representative = elements[blockFirst[block]];
+    minimized.accepting[block] = dfa.accepting[representative];
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      minimized.transitions[block * numClasses + byteClass] =
+          blockOf[dfa.nextClass(representative, byteClass)];
+    }
+  }
+  minimized.startState = blockOf[dfa.startState];
+  minimized.deadState = dfa.deadState < 0 ? -1 : blockOf[dfa.deadState];
+  return minimized;
+}
+
+/*
+ * Function: CompileDFA
+ *
+ *  Determinize and minimize an NFA.
+ *
+ *  @param nfa The frozen NFA
+ *  @param stats If not null, receives the state count of every stage
+ *
+ *  @return The minimal DFA
+ */
+DFA CompileDFA(const FrozenNFA &nfa, DFAStats *stats) {
+  DFA determinized = DeterminizeNFA(nfa);
+  DFA minimized = MinimizeDFA(determinized);
+
+  if (stats != nullptr) {
+    stats->nfaStates = nfa.numStates();
+    stats->dfaStates = determinized.numStates();
+    stats->minimizedStates = minimized.numStates();
+    stats->byteClasses = minimized.numClasses();
+  }
+  return minimized;
+}
+
+/*
+ * Function: RunDFA
+ *  Alternative to RunNFA that walks a compiled DFA table, one lookup per
+ *  input byte.
+ *
+ * @param dfa
+ * @param startIndex
+ * @param input
+ *
+ * @return -1 if terminal not found.
+ */
+int RunDFA(const DFA &dfa, int startIndex, std::string_view input) {
+  int state = dfa.startState;
+  for (size_t index = startIndex; index < input.size(); index++) {
+    state = dfa.next(state, (unsigned char)input[index]);
+    if (state == dfa.deadState) {
+      return -1;
+    }
+  }
+
+  if (!dfa.accepting[state]) {
+    return -1;
+  }
+  return input.size() - startIndex;
+}
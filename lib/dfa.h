@@ -0,0 +1,150 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include "frozen.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/* Default memory budget for the cached states of a LazyDFA, in bytes */
+#define DFA_CACHE_BUDGET_DEFAULT (1 << 20)
+
+/* Marks a DFA transition that has not been determinized yet */
+#define DFA_UNKNOWN -1
+
+/* Flushes that make too little progress before the DFA gives up on caching */
+#define DFA_THRASH_LIMIT 3
+
+/*
+ * struct: DFAState
+ *
+ * One state of a lazily built DFA, standing for a set of NFA states.
+ *
+ * @field nfaStates: The FrozenNFA states this state stands for, sorted so
+ * equal sets compare equal.
+ * @field isAccepting: True if any of the NFA states is terminal.
+ * @field transitions: Target state for every byte class of the NFA, or
+ * DFA_UNKNOWN if the transition has not been computed yet.
+ *
+ */
+struct DFAState {
+  std::vector<uint32_t> nfaStates;
+  bool isAccepting;
+  std::vector<int> transitions;
+};
+
+/*
+ * class: LazyDFA
+ *
+ * DFA built on demand from an NFA: a state and its transitions are only
+ * determinized the first time the input reaches them. Cached states are kept
+ * under a memory budget; when the budget is exceeded the cache is flushed and
+ * rebuilt from the current state. If flushes keep happening without much
+ * progress the run falls back to plain NFA simulation.
+ *
+ */
+class LazyDFA {
+public:
+  explicit LazyDFA(const FrozenNFA &frozenNFA,
+                   size_t cacheBudget = DFA_CACHE_BUDGET_DEFAULT);
+
+  int run(int startIndex, std::string_view input);
+
+  /* Resumable stepping, used by run and by StreamMatcher */
+  int startMatch();
+  int advance(int state, unsigned char symbol);
+  bool isAccepting(int state) const { return states[state].isAccepting; }
+  bool isDead(int state) const { return states[state].nfaStates.empty(); }
+  const std::vector<uint32_t> &nfaStatesOf(int state) const {
+    return states[state].nfaStates;
+  }
+  const FrozenNFA &automaton() const { return nfa; }
+
+  /* Statistics, mostly useful when tuning the cache budget */
+  size_t cachedStates() const { return states.size(); }
+  size_t cacheFlushes() const { return flushCount; }
+  size_t nfaFallbacks() const { return fallbackCount; }
+
+private:
+  FrozenNFA nfa;
+  size_t cacheBudget;
+  size_t cacheBytes;
+  size_t flushCount;
+  size_t fallbackCount;
+
+  // Thrash detection for the match in progress
+  size_t bytesSinceFlush;
+  int wastedFlushes;
+
+  std::vector<DFAState> states;
+  std::map<std::vector<uint32_t>, int> stateIds;
+  int startState;
+
+  // Scratch space for determinizing transitions
+  SparseSet currentSet;
+  SparseSet nextSet;
+  std::vector<uint32_t> stack;
+
+  int addState(std::vector<uint32_t> nfaStates);
+  int computeTransition(int state, int byteClass);
+  void flushCache();
+  bool finishWithNFA(const std::vector<uint32_t> &nfaStates, int index,
+                     std::string_view input);
+};
+
+/*
+ * struct: DFA
+ *
+ * Fully determinized automaton stored as a dense transition table. The table
+ * is total: inputs that cannot lead to an accept go to an explicit dead state.
+ * Columns are byte classes rather than bytes, so a row is usually a few
+ * entries instead of 256.
+ *
+ * @field byteClasses: Byte to column mapping, taken from the NFA.
+ * @field transitions: Row-major table, byteClasses.numClasses entries per
+ * state.
+ * @field accepting: True for accepting states.
+ * @field startState: Index of the start state.
+ * @field deadState: Index of the dead state, or -1 if every state can still
+ * reach an accept.
+ *
+ */
+struct DFA {
+  ByteClasses byteClasses;
+  std::vector<int> transitions;
+  std::vector<bool> accepting;
+  int startState;
+  int deadState;
+
+  int numStates() const { return accepting.size(); }
+  int numClasses() const { return byteClasses.numClasses; }
+  int nextClass(int state, int byteClass) const {
+    return transitions[state * byteClasses.numClasses + byteClass];
+  }
+  int next(int state, unsigned char symbol) const {
+    return nextClass(state, byteClasses.map[symbol]);
+  }
+};
+
+/*
+ * struct: DFAStats
+ *
+ * State counts of the stages CompileDFA goes through.
+ *
+ */
+struct DFAStats {
+  size_t nfaStates;
+  size_t dfaStates;
+  size_t minimizedStates;
+  size_t byteClasses;
+};
+
+/* Function Prototypes */
+int RunLazyDFA(LazyDFA &dfa, int startIndex, std::string_view input);
+DFA DeterminizeNFA(const FrozenNFA &nfa);
+DFA MinimizeDFA(const DFA &dfa);
+DFA CompileDFA(const FrozenNFA &nfa, DFAStats *stats = nullptr);
+int RunDFA(const DFA &dfa, int startIndex, std::string_view input);
+
+#endif /* DFA_H */
@@ -0,0 +1,361 @@
+#include "frozen.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <unordered_map>
+
+/*
+ * Function: freeze
+ *
+ *  Convert the Node graph reachable from startNode into a FrozenNFA. Nodes
+ *  are numbered in breadth-first order so states that follow each other are
+ *  close in memory, and token identifiers and character classes are interned
+ *  to small integers. Token ids follow the order the identifiers are first
+ *  reached in.
+ *
+ *  @param startNode Start node of the NFA
+ *
+ *  @return The frozen automaton; the start node becomes state 0
+ */
+FrozenNFA freeze(Node *startNode) {
+  FrozenNFA nfa;
+  std::unordered_map<Node *, uint32_t> stateIds;
+  std::unordered_map<std::string, uint16_t> tokenIds;
+  std::map<std::array<uint64_t, 4>, uint32_t> classIds;
+  std::vector<Node *> nodes = {startNode};
+
+  stateIds.emplace(startNode, 0);
+  nfa.startState = 0;
+  nfa.tokenNames.push_back("");
+  tokenIds.emplace("", NO_TOKEN);
+
+  // Number every reachable node
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (auto &transition : nodes[i]->transitions) {
+      if (stateIds.find(transition.second) == stateIds.end()) {
+        stateIds.emplace(transition.second, nodes.size());
+        nodes.push_back(transition.second);
+      }
+    }
+  }
+
+  nfa.edgeOffsets.push_back(0);
+  nfa.classEdgeOffsets.push_back(0);
+  nfa.epsilonOffsets.push_back(0);
+  for (Node *node : nodes) {
+    size_t firstEdge = nfa.edges.size();
+    for (auto &transition : node->transitions) {
+      uint32_t target = stateIds[transition.second];
+      if (transition.first.type == Label::EPSILON) {
+        nfa.epsilonTargets.push_back(target);
+      } else if (transition.first.type == Label::CLASS) {
+        const CharClass &charClass = *transition.first.charClass;
+        std::array<uint64_t, 4> key = {charClass.bits[0], charClass.bits[1],
+                                       charClass.bits[2], charClass.bits[3]};
+        auto found = classIds.find(key);
+        if (found == classIds.end()) {
+          found = classIds.emplace(key, nfa.classes.size()).first;
+          nfa.classes.push_back(charClass);
+        }
+        nfa.classEdges.push_back({found->second, target});
+      } else {
+        nfa.edges.push_back({(unsigned char)transition.first.value, target});
+      }
+    }
+    std::stable_sort(nfa.edges.begin() + firstEdge, nfa.edges.end(),
+                     [](const FrozenEdge &lhs, const FrozenEdge &rhs) {
+                       return lhs.symbol < rhs.symbol;
+                     });
+    nfa.edgeOffsets.push_back(nfa.edges.size());
+    nfa.classEdgeOffsets.push_back(nfa.classEdges.size());
+    nfa.epsilonOffsets.push_back(nfa.epsilonTargets.size());
+
+    auto token = tokenIds.find(node->tokenIdentifier);
+    if (token == tokenIds.end()) {
+      token = tokenIds.emplace(node->tokenIdentifier, nfa.tokenNames.size())
+                  .first;
+      nfa.tokenNames.push_back(node->tokenIdentifier);
+    }
+    nfa.tokenIds.push_back(token->second);
+    nfa.isTerminal.push_back(node->isTerminalNode ? 1 : 0);
+  }
+
+  nfa.byteClasses = ComputeByteClasses(nfa);
+  return nfa;
+}
+
+/*
+ * Function: SplitByteClasses
+ *
+ *  Refine a byte partition with one set of bytes: every class that has bytes
+ *  both inside and outside the set is split in two.
+ *
+ *  @param byteClasses Partition to refine
+ *  @param bytes Set of bytes some transition is taken on
+ */
+static void SplitByteClasses(ByteClasses &byteClasses,
+                             const CharClass &bytes) {
+  bool hasOutside[256] = {false};
+  for (int byte = 0; byte < 256; byte++) {
+    if (!bytes.contains(byte)) {
+      hasOutside[byteClasses.map[byte]] = true;
+    }
+  }
+
+  int splitInto[256];
+  std::fill(std::begin(splitInto), std::end(splitInto), -1);
+  for (int byte = 0; byte < 256; byte++) {
+    int byteClass = byteClasses.map[byte];
+    if (!bytes.contains(byte) || !hasOutside[byteClass]) {
+      continue;
+    }
+    if (splitInto[byteClass] < 0) {
+      splitInto[byteClass] = byteClasses.numClasses++;
+    }
+    byteClasses.map[byte] = splitInto[byteClass];
+  }
+}
+
+/*
+ * Function: ComputeByteClasses
+ *
+ *  Partition the input bytes so that two bytes share a class exactly when
+ *  every character and class edge of the automaton either accepts both or
+ *  neither. Any table over the automaton can then use one column per class.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The byte classes, numbered in order of their smallest byte
+ */
+ByteClasses ComputeByteClasses(const FrozenNFA &nfa) {
+  ByteClasses byteClasses;
+  std::fill(std::begin(byteClasses.map), std::end(byteClasses.map), 0);
+  byteClasses.numClasses = 1;
+
+  // A single byte only needs to split the partition once
+  CharClass seenSymbols = {};
+  for (const FrozenEdge &edge : nfa.edges) {
+    if (seenSymbols.contains(edge.symbol)) {
+      continue;
+    }
+    seenSymbols.add(edge.symbol);
+    CharClass symbol = {};
+    symbol.add(edge.symbol);
+    SplitByteClasses(byteClasses, symbol);
+  }
+  for (const CharClass &charClass : nfa.classes) {
+    SplitByteClasses(byteClasses, charClass);
+  }
+
+  // Renumber by smallest byte so the partition has a canonical form
+  int renumbered[256];
+  std::fill(std::begin(renumbered), std::end(renumbered), -1);
+  int numClasses = 0;
+  for (int byte = 0; byte < 256; byte++) {
+    int byteClass = byteClasses.map[byte];
+    if (renumbered[byteClass] < 0) {
+      renumbered[byteClass] = numClasses;
+      byteClasses.representatives[numClasses] = byte;
+      numClasses++;
+    }
+    byteClasses.map[byte] = renumbered[byteClass];
+  }
+  return byteClasses;
+}
+
+/*
+ * Function: AddFrozenState
+ *
+ *  Add a state and its epsilon closure to stateSet. States already in the set
+ *  are skipped, so epsilon cycles terminate.
+ *
+ *  @param nfa The frozen automaton
+ *  @param stateSet Set of states being built for the current step
+ *  @param state State to add
+ *  @param stack Scratch space for the closure walk
+ */
+void AddFrozenState(const FrozenNFA &nfa, SparseSet &stateSet, uint32_t state,
+                    std::vector<uint32_t> &stack) {
+  if (stateSet.contains(state)) {
+    return;
+  }
+  stateSet.insert(state);
+  stack.push_back(state);
+
+  while (!stack.empty()) {
+    uint32_t current = stack.back();
+    stack.pop_back();
+    for (uint32_t i = nfa.epsilonOffsets[current];
+         i < nfa.epsilonOffsets[current + 1]; i++) {
+      uint32_t target = nfa.epsilonTargets[i];
+      if (!stateSet.contains(target)) {
+        stateSet.insert(target);
+        stack.push_back(target);
+      }
+    }
+  }
+}
+
+/*
+ * Function: StepFrozenState
+ *
+ *  Follow the transitions of one state over one input byte. Character edges
+ *  are sorted by symbol, so the matching ones are found with a binary search;
+ *  class edges are one bitmap lookup each.
+ *
+ *  @param nfa The frozen automaton
+ *  @param state State to leave
+ *  @param symbol The input byte
+ *  @param nextStates Receives the states reached, with their epsilon closure
+ *  @param stack Scratch space for the closure walk
+ */
+void StepFrozenState(const FrozenNFA &nfa, uint32_t state,
+                     unsigned char symbol, SparseSet &nextStates,
+                     std::vector<uint32_t> &stack) {
+  const FrozenEdge *first = nfa.edges.data() + nfa.edgeOffsets[state];
+  const FrozenEdge *last = nfa.edges.data() + nfa.edgeOffsets[state + 1];
+  const FrozenEdge *edge =
+      std::lower_bound(first, last, symbol,
+                       [](const FrozenEdge &lhs, unsigned char value) {
+                         return lhs.symbol < value;
+                       });
+  for (; edge != last && edge->symbol == symbol; edge++) {
+    AddFrozenState(nfa, nextStates, edge->target, stack);
+  }
+
+  for (uint32_t i = nfa.classEdgeOffsets[state];
+       i < nfa.classEdgeOffsets[state + 1]; i++) {
+    const FrozenClassEdge &classEdge = nfa.classEdges[i];
+    if (nfa.classes[classEdge.classId].contains(symbol)) {
+      AddFrozenState(nfa, nextStates, classEdge.target, stack);
+    }
+  }
+}
+
+/*
+ * Function: StepFrozenStates
+ *
+ *  Advance every state in currentStates over one input byte.
+ *
+ *  @param nfa The frozen automaton
+ *  @param currentStates States active before reading symbol
+ *  @param symbol The input byte
+ *  @param nextStates Receives the states active after reading symbol
+ *  @param stack Scratch space for the closure walk
+ */
+void StepFrozenStates(const FrozenNFA &nfa, const SparseSet &currentStates,
+                      unsigned char symbol, SparseSet &nextStates,
+                      std::vector<uint32_t> &stack) {
+  for (uint32_t state : currentStates) {
+    StepFrozenState(nfa, state, symbol, nextStates, stack);
+  }
+}
+
+/*
+ * Function: AcceptingToken
+ *
+ *  @param nfa The frozen automaton
+ *  @param stateSet Active states
+ *
+ *  @return Smallest token id of an accepting state in the set, -1 if none of
+ *  them accepts
+ */
+static int AcceptingToken(const FrozenNFA &nfa, const SparseSet &stateSet) {
+  int tokenId = -1;
+  for (uint32_t state : stateSet) {
+    if (nfa.isTerminal[state] &&
+        (tokenId < 0 || nfa.tokenIds[state] < tokenId)) {
+      tokenId = nfa.tokenIds[state];
+    }
+  }
+  return tokenId;
+}
+
+/*
+ * Function: MatchNFA
+ *
+ *  Test whether the automaton accepts the whole input. Only the scratch space
+ *  is written, so threads with their own scratch can match concurrently.
+ *
+ *  @param nfa The frozen automaton
+ *  @param input The input
+ *  @param scratch Working memory of the simulation
+ *
+ *  @return The input length and accepting token, or length -1
+ */
+MatchResult MatchNFA(const FrozenNFA &nfa, std::string_view input,
+                     MatchScratch &scratch) {
+  scratch.currentSet.clear();
+  AddFrozenState(nfa, scratch.currentSet, nfa.startState, scratch.stack);
+  for (size_t i = 0; i < input.size() && !scratch.currentSet.empty(); i++) {
+    scratch.nextSet.clear();
+    StepFrozenStates(nfa, scratch.currentSet, input[i], scratch.nextSet,
+                     scratch.stack);
+    std::swap(scratch.currentSet, scratch.nextSet);
+  }
+
+  int tokenId = AcceptingToken(nfa, scratch.currentSet);
+  if (tokenId < 0) {
+    return {-1, NO_TOKEN};
+  }
+  return {(int)input.size(), (uint16_t)tokenId};
+}
+
+/*
+ * Function: LongestMatchNFA
+ *
+ *  Find the longest prefix of the input the automaton accepts, the way a
+ *  lexer picks its next token. The scan stops as soon as no state is active.
+ *  Token ids are interned in breadth-first order, so for a ThompsonNFA union
+ *  a tie between tokens goes to the rule listed first.
+ *
+ *  @param nfa The frozen automaton
+ *  @param input The input
+ *  @param scratch Working memory of the simulation
+ *
+ *  @return Length and token of the longest accepted prefix, or length -1
+ */
+MatchResult LongestMatchNFA(const FrozenNFA &nfa, std::string_view input,
+                            MatchScratch &scratch) {
+  MatchResult result = {-1, NO_TOKEN};
+  scratch.currentSet.clear();
+  AddFrozenState(nfa, scratch.currentSet, nfa.startState, scratch.stack);
+  for (size_t i = 0;; i++) {
+    int tokenId = AcceptingToken(nfa, scratch.currentSet);
+    if (tokenId >= 0) {
+      result = {(int)i, (uint16_t)tokenId};
+    }
+    if (i == input.size()) {
+      break;
+    }
+
+    scratch.nextSet.clear();
+    StepFrozenStates(nfa, scratch.currentSet, input[i], scratch.nextSet,
+                     scratch.stack);
+    std::swap(scratch.currentSet, scratch.nextSet);
+    if (scratch.currentSet.empty()) {
+      break;
+    }
+  }
+  return result;
+}
+
+/*
+ * Function: RunNFA
+ *  Simulate a frozen NFA one input byte at a time, keeping the active states
+ *  in sparse sets. Scratch space is local to the call, so RunNFA is safe to
+ *  call from several threads.
+ *
+ * @param nfa
+ * @param startIndex
+ * @param input
+ *
+ * @return -1 if terminal not found.
+ */
+int RunNFA(const FrozenNFA &nfa, int startIndex, std::string_view input) {
+  if (startIndex > (int)input.size()) {
+    return -1;
+  }
+  MatchScratch scratch(nfa);
+  return MatchNFA(nfa, input.substr(startIndex), scratch).length;
+}
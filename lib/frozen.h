@@ -0,0 +1,186 @@
+#ifndef FROZEN_H
+#define FROZEN_H
+
+#include "nfa.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Token id of a state whose node had no token identifier */
+#define NO_TOKEN 0
+
+/*
+ * struct: FrozenEdge
+ *
+ * Character transition of a FrozenNFA.
+ *
+ * @field symbol: Input byte the transition is taken on.
+ * @field target: Index of the state the transition leads to.
+ *
+ */
+struct FrozenEdge {
+  unsigned char symbol;
+  uint32_t target;
+};
+
+/*
+ * struct: FrozenClassEdge
+ *
+ * Character class transition of a FrozenNFA.
+ *
+ * @field classId: Index into FrozenNFA::classes of the accepted bytes.
+ * @field target: Index of the state the transition leads to.
+ *
+ */
+struct FrozenClassEdge {
+  uint32_t classId;
+  uint32_t target;
+};
+
+/*
+ * struct: ByteClasses
+ *
+ * Partition of the 256 input bytes into classes that every transition of an
+ * automaton treats alike. A table indexed by class needs one column per class
+ * instead of one per byte.
+ *
+ * @field map: Class of every byte. Classes are numbered in order of their
+ * smallest byte.
+ * @field representatives: Smallest byte of every class.
+ * @field numClasses: Number of classes.
+ *
+ */
+struct ByteClasses {
+  uint8_t map[256];
+  uint8_t representatives[256];
+  uint16_t numClasses;
+};
+
+/*
+ * struct: FrozenNFA
+ *
+ * Compact, read-only layout of an NFA built from Node graphs. States are
+ * 32-bit indices and all transitions live in a few contiguous arrays, so
+ * matching walks memory linearly instead of chasing Node pointers.
+ *
+ * @field startState: Index of the start state.
+ * @field edgeOffsets: Character transitions of state s are
+ * edges[edgeOffsets[s], edgeOffsets[s + 1]), sorted by symbol.
+ * @field edges: Character transitions of every state (CSR layout).
+ * @field classEdgeOffsets: Class transitions of state s are
+ * classEdges[classEdgeOffsets[s], classEdgeOffsets[s + 1]).
+ * @field classEdges: Class transitions of every state (CSR layout).
+ * @field classes: Distinct character classes used by classEdges.
+ * @field epsilonOffsets: Epsilon transitions of state s are
+ * epsilonTargets[epsilonOffsets[s], epsilonOffsets[s + 1]).
+ * @field epsilonTargets: Epsilon transition targets of every state.
+ * @field isTerminal: Nonzero for accepting states.
+ * @field tokenIds: Interned token identifier of every state.
+ * @field tokenNames: Token identifier strings, indexed by token id. Id
+ * NO_TOKEN is the empty identifier.
+ * @field byteClasses: Bytes that no transition tells apart share a class.
+ *
+ */
+struct FrozenNFA {
+  uint32_t startState;
+  std::vector<uint32_t> edgeOffsets;
+  std::vector<FrozenEdge> edges;
+  std::vector<uint32_t> classEdgeOffsets;
+  std::vector<FrozenClassEdge> classEdges;
+  std::vector<CharClass> classes;
+  std::vector<uint32_t> epsilonOffsets;
+  std::vector<uint32_t> epsilonTargets;
+  std::vector<uint8_t> isTerminal;
+  std::vector<uint16_t> tokenIds;
+  std::vector<std::string> tokenNames;
+  ByteClasses byteClasses;
+
+  uint32_t numStates() const { return isTerminal.size(); }
+};
+
+/*
+ * class: SparseSet
+ *
+ * Set of state indices below a fixed capacity with O(1) insert, lookup and
+ * clear, iterated in insertion order. Used for the active state lists of the
+ * NFA simulation.
+ *
+ */
+class SparseSet {
+public:
+  explicit SparseSet(uint32_t capacity)
+      : dense(capacity), sparse(capacity), count(0) {};
+
+  bool contains(uint32_t value) const {
+    uint32_t index = sparse[value];
+    return index < count && dense[index] == value;
+  }
+  void insert(uint32_t value) {
+    sparse[value] = count;
+    dense[count++] = value;
+  }
+  void clear() { count = 0; }
+  bool empty() const { return count == 0; }
+  uint32_t size() const { return count; }
+  const uint32_t *begin() const { return dense.data(); }
+  const uint32_t *end() const { return dense.data() + count; }
+
+private:
+  std::vector<uint32_t> dense;
+  std::vector<uint32_t> sparse;
+  uint32_t count;
+};
+
+/*
+ * struct: MatchResult
+ *
+ * Outcome of an anchored match.
+ *
+ * @field length: Number of input bytes matched, -1 if nothing matched.
+ * @field tokenId: Token of the accepting state, an index into
+ * FrozenNFA::tokenNames. If states of several tokens accept, the smallest id
+ * wins.
+ *
+ */
+struct MatchResult {
+  int length;
+  uint16_t tokenId;
+};
+
+/*
+ * struct: MatchScratch
+ *
+ * Working memory of one NFA simulation. Each thread matching concurrently
+ * needs its own; reusing one across calls avoids allocating per match. It
+ * must be built for an automaton at least as large as the one it is used
+ * with.
+ *
+ */
+struct MatchScratch {
+  explicit MatchScratch(const FrozenNFA &nfa)
+      : currentSet(nfa.numStates()), nextSet(nfa.numStates()) {}
+
+  SparseSet currentSet;
+  SparseSet nextSet;
+  std::vector<uint32_t> stack;
+};
+
+/* Function Prototypes */
+FrozenNFA freeze(Node *startNode);
+ByteClasses ComputeByteClasses(const FrozenNFA &nfa);
+void AddFrozenState(const FrozenNFA &nfa, SparseSet &stateSet, uint32_t state,
+                    std::vector<uint32_t> &stack);
+void StepFrozenState(const FrozenNFA &nfa, uint32_t state,
+                     unsigned char symbol, SparseSet &nextStates,
+                     std::vector<uint32_t> &stack);
+void StepFrozenStates(const FrozenNFA &nfa, const SparseSet &currentStates,
+                      unsigned char symbol, SparseSet &nextStates,
+                      std::vector<uint32_t> &stack);
+MatchResult MatchNFA(const FrozenNFA &nfa, std::string_view input,
+                     MatchScratch &scratch);
+MatchResult LongestMatchNFA(const FrozenNFA &nfa, std::string_view input,
+                            MatchScratch &scratch);
+int RunNFA(const FrozenNFA &nfa, int startIndex, std::string_view input);
+
+#endif /* FROZEN_H */
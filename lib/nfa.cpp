@@ -1,83 +1,66 @@
 #include "nfa.h"
-
-/* Declaring extern locally */
-std::priority_queue<std::pair<int, std::string>,
-                    std::vector<std::pair<int, std::string>>, ComparePair>
-    lengthPQ;
+#include "frozen.h"
+#include "search.h"
 
 /*
- * Function: TransitionState
- *
- *  Add any of the next states of the currentState to the nextStates queue
- *  For character transition make sure to increment index, for epsilon
- *  transition make sure not to increment index Return true if reaches terminal
- *  node and input is exhausted
+ * Function: RunNFA
+ *  Freeze the Node graph and simulate it one character at a time, keeping
+ *  the set of active states (Thompson/Pike simulation). Every state appears
+ *  at most once per step, so the run is O(n * m) for n input characters and
+ *  m states. Callers that test the same NFA repeatedly should freeze it once
+ *  and use the FrozenNFA overload instead.
  *
- *  @param currentState Current state of the NFA
- *  @param input Represents the symbol (or epsilon) being processed
- *  @param nextStates Represents a queue that holds all states that haven't been
- * processed
+ * @param startNode
+ * @param startIndex
+ * @param input
  *
- * @return TRUE if terminal node is found, otherwise FALSE
+ * @return -1 if terminal not found.
  */
-bool TransitionState(State &currentState, std::string input,
-                     std::queue<State> &nextStates) {
-  bool reachedTerminal = false;
-  // transition is one value from pair<Label, Node*>
-  for (auto transition : currentState.currentNode->transitions) {
-    // Handle epsilon transition
-    if (transition.first.type == Label::EPSILON) {
-
-      nextStates.push({currentState.currentIndex, transition.second});
-      if (transition.second->isTerminalNode && currentState.currentIndex == input.size()) { // LIB
-        lengthPQ.push(std::make_pair(currentState.currentIndex,
-                                     transition.second->tokenIdentifier));
-        reachedTerminal = true;
-      }
-    }
-    // Handle input char is one of the transitions
-    else if (transition.first.value == input[currentState.currentIndex]) {
-      nextStates.push({currentState.currentIndex + 1, transition.second});
-      if (transition.second->isTerminalNode && (currentState.currentIndex + 1) == input.size()) { // LIB
-        lengthPQ.push(std::make_pair(currentState.currentIndex + 1,
-                                     transition.second->tokenIdentifier));
-        reachedTerminal = true;
-      }
-    }
-  }
-  return reachedTerminal;
+int RunNFA(Node *startNode, int startIndex, std::string_view input) {
+  return RunNFA(freeze(startNode), startIndex, input);
 }
 
 /*
- * Function: RunNFA
- *  Initialize nextStates queue with starting state
- *  Pop off queue and run TransitionState on dequeued state
- *  Continue until empty queue or TransitionState returns true
+ * Function: FirstMatchNFA
+ *  Find the match that ends first anywhere in the input, starting the scan at
+ *  startIndex. Of the matches ending there, the one starting leftmost is
+ *  returned.
  *
  * @param startNode
+ * @param startIndex
  * @param input
  *
- * @return -1 if terminal not found.
+ * @return The match, or {-1, -1} if there is none.
  */
-int RunNFA(Node *startNode, int startIndex, std::string input) {
-  // empty the PQ
-  while (!lengthPQ.empty()) {
-    lengthPQ.pop();
-  }
-
-  std::queue<State> nextStates;
-
-  State currState = {startIndex, startNode};
-  nextStates.push(currState);
+Match FirstMatchNFA(Node *startNode, int startIndex, std::string_view input) {
+  return FirstMatchNFA(freeze(startNode), startIndex, input);
+}
 
-  while (!nextStates.empty()) {
-    currState = nextStates.front();
-    TransitionState(currState, input, nextStates);
-    nextStates.pop();
-  }
+/*
+ * Function: SearchNFA
+ *  Find the leftmost-longest match anywhere in the input, starting the scan
+ *  at startIndex.
+ *
+ * @param startNode
+ * @param startIndex
+ * @param input
+ *
+ * @return The match, or {-1, -1} if there is none.
+ */
+Match SearchNFA(Node *startNode, int startIndex, std::string_view input) {
+  return SearchNFA(freeze(startNode), startIndex, input);
+}
 
-  if (lengthPQ.empty() || lengthPQ.top().first != input.size()) { // LIB
-    return -1;
-  }
-  return lengthPQ.top().first - startIndex;
+/*
+ * Function: FindAllNFA
+ *  Collect every non-overlapping leftmost-longest match, scanning the input
+ *  from left to right.
+ *
+ * @param startNode
+ * @param input
+ *
+ * @return The matches in order of their start.
+ */
+std::vector<Match> FindAllNFA(Node *startNode, std::string_view input) {
+  return FindAllNFA(freeze(startNode), input);
 }
@@ -1,47 +1,49 @@
 #ifndef NFA_H
 #define NFA_H
 
+#include <cstdint>
 #include <iostream>
-#include <queue>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 /*
- * struct ComparePair
+ * struct: CharClass
  *
- * Updates comparison operator to help with priority queue operations.
- * Set the < to > if want to check for smallest value (I can't think of a case
- * where this would be useful)
+ * Set of bytes stored as a 256-bit bitmap. A CLASS transition accepts every
+ * byte in its class, so a bracket such as (a-z) is a single edge and testing
+ * it is one bit lookup.
  *
  */
-struct ComparePair {
-  bool operator()(const std::pair<int, std::string> &lhs,
-                  const std::pair<int, std::string> &rhs) const {
-    // Compare based on the first element of the pair (the int)
-    return lhs.first < rhs.first; // Change > to < if you want ascending order
+struct CharClass {
+  uint64_t bits[4];
+
+  void add(unsigned char chr) { bits[chr >> 6] |= 1ULL << (chr & 63); }
+  void addRange(unsigned char low, unsigned char high) {
+    for (int chr = low; chr <= high; chr++) {
+      add(chr);
+    }
+  }
+  bool contains(unsigned char chr) const {
+    return (bits[chr >> 6] >> (chr & 63)) & 1;
   }
 };
 
-/*
- * Priority queue used to store nodes. This holds all states that have accepted.
- */
-extern std::priority_queue<std::pair<int, std::string>,
-                           std::vector<std::pair<int, std::string>>,
-                           ComparePair>
-    lengthPQ;
-
 /*
  * struct: Label
  *
  * Holds the value of the transition. In the case of an epsilon transition, type
  * should be set to EPSILON, and the value of char value field is undefined.
+ * For a CLASS transition the accepted bytes are in charClass.
  *
  */
 struct Label {
-  enum { EPSILON, CHAR } type;
+  enum { EPSILON, CHAR, CLASS } type;
   // char is undefined when type is epsilon
   char value;
+  // Only set when type is CLASS
+  const CharClass *charClass;
 };
 
 /*
@@ -65,26 +67,21 @@ struct Node {
 };
 
 /*
- * struct: State
- *
- * Struct holding value for this current run. Holds the index that is currently
- * being viewed.
+ * struct: Match
  *
- * @field currentIndex: current index of the input string
- * @field currentNode: pointer to the node attached to this state
+ * Location of a match inside a larger input, as the half-open range
+ * [start, end). Both fields are -1 when nothing matched.
  *
  */
-struct State {
-  // The current index represents where you are in the input string for this run
-  int currentIndex;
-  // The current node is
-  // a pointer to where you are in the graph
-  Node *currentNode;
+struct Match {
+  int start;
+  int end;
 };
 
 /* Function Prototypes */
-bool TransitionState(State &currentState, std::string input,
-                     std::queue<State> &nextStates);
-int RunNFA(Node *startNode, int startIndex, std::string input);
+int RunNFA(Node *startNode, int startIndex, std::string_view input);
+Match FirstMatchNFA(Node *startNode, int startIndex, std::string_view input);
+Match SearchNFA(Node *startNode, int startIndex, std::string_view input);
+std::vector<Match> FindAllNFA(Node *startNode, std::string_view input);
 
 #endif /* NFA_H */
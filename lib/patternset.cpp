@@ -0,0 +1,328 @@
+#include "patternset.h"
+
+/*
+ * Function: ExactLiteral
+ *
+ *  Check whether an automaton accepts exactly one string. The state sets are
+ *  walked while every step has a single possible byte; the string ends at the
+ *  first accepting set, which must have no way to continue. A longer walk
+ *  than the automaton has states would have to repeat a state, so it gives
+ *  up there.
+ *
+ *  @param nfa The frozen automaton
+ *  @param literal Receives the accepted string
+ *
+ *  @return TRUE if the automaton accepts literal and nothing else
+ */
+static bool ExactLiteral(const FrozenNFA &nfa, std::string &literal) {
+  SparseSet currentStates(nfa.numStates());
+  SparseSet nextStates(nfa.numStates());
+  std::vector<uint32_t> stack;
+  AddFrozenState(nfa, currentStates, nfa.startState, stack);
+  literal.clear();
+
+  while (literal.size() <= nfa.numStates()) {
+    bool accepting = false;
+    CharClass bytes = {};
+    for (uint32_t state : currentStates) {
+      accepting |= nfa.isTerminal[state] != 0;
+      for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+           i++) {
+        bytes.add(nfa.edges[i].symbol);
+      }
+      for (uint32_t i = nfa.classEdgeOffsets[state];
+           i < nfa.classEdgeOffsets[state + 1]; i++) {
+        const CharClass &charClass = nfa.classes[nfa.classEdges[i].classId];
+        for (int word = 0; word < 4; word++) {
+          bytes.bits[word] |= charClass.bits[word];
+        }
+      }
+    }
+
+    int numBytes = 0;
+    for (int word = 0; word < 4; word++) {
+      numBytes += __builtin_popcountll(bytes.bits[word]);
+    }
+    if (accepting) {
+      return numBytes == 0;
+    }
+    if (numBytes != 1) {
+      return false;
+    }
+
+    int byte = 0;
+    while (!bytes.contains(byte)) {
+      byte++;
+    }
+    nextStates.clear();
+    StepFrozenStates(nfa, currentStates, byte, nextStates, stack);
+    std::swap(currentStates, nextStates);
+    literal += (char)byte;
+  }
+  return false;
+}
+
+/*
+ * Function: PatternSet::PatternSet
+ *
+ *  Compile the patterns into an Aho-Corasick automaton if all of them are
+ *  literals, and into one unioned NFA otherwise.
+ *
+ *  @param patterns The automata to match with; they are copied
+ */
+PatternSet::PatternSet(const std::vector<const FrozenNFA *> &patterns)
+    : numPatterns(patterns.size()), isLiteralSet(true), currentSet(0),
+      nextSet(0), found(patterns.size(), 0) {
+  std::vector<std::string> literals(patterns.size());
+  for (int id = 0; id < numPatterns && isLiteralSet; id++) {
+    isLiteralSet = ExactLiteral(*patterns[id], literals[id]);
+  }
+
+  if (isLiteralSet) {
+    buildAhoCorasick(literals);
+  } else {
+    buildUnion(patterns);
+  }
+}
+
+/*
+ * Function: PatternSet::buildUnion
+ *
+ *  Lay the patterns out one after another in a single FrozenNFA behind a new
+ *  start state with an epsilon transition to every pattern's start.
+ *
+ *  @param patterns The automata to union
+ */
+void PatternSet::buildUnion(const std::vector<const FrozenNFA *> &patterns) {
+  nfa.startState = 0;
+  nfa.edgeOffsets = {0, 0};
+  nfa.classEdgeOffsets = {0, 0};
+  nfa.epsilonOffsets = {0};
+  nfa.tokenNames = {""};
+
+  uint32_t stateBase = 1;
+  for (const FrozenNFA *pattern : patterns) {
+    nfa.epsilonTargets.push_back(stateBase + pattern->startState);
+    stateBase += pattern->numStates();
+  }
+  nfa.epsilonOffsets.push_back(nfa.epsilonTargets.size());
+  nfa.isTerminal.push_back(0);
+  nfa.tokenIds.push_back(NO_TOKEN);
+  patternOf.push_back(0);
+
+  stateBase = 1;
+  for (int id = 0; id < numPatterns; id++) {
+    const FrozenNFA &pattern = *patterns[id];
+    uint32_t edgeBase = nfa.edges.size();
+    uint32_t classEdgeBase = nfa.classEdges.size();
+    uint32_t classBase = nfa.classes.size();
+    uint32_t epsilonBase = nfa.epsilonTargets.size();
+
+    for (const FrozenEdge &edge : pattern.edges) {
+      nfa.edges.push_back({edge.symbol, stateBase + edge.target});
+    }
+    for (const FrozenClassEdge &classEdge : pattern.classEdges) {
+      nfa.classEdges.push_back(
+          {classBase + classEdge.classId, stateBase + classEdge.target});
+    }
+    nfa.classes.insert(nfa.classes.end(), pattern.classes.begin(),
+                       pattern.classes.end());
+    for (uint32_t target : pattern.epsilonTargets) {
+      nfa.epsilonTargets.push_back(stateBase + target);
+    }
+
+    for (uint32_t state = 0; state < pattern.numStates(); state++) {
+      nfa.edgeOffsets.push_back(edgeBase + pattern.edgeOffsets[state + 1]);
+      nfa.classEdgeOffsets.push_back(classEdgeBase +
+                                     pattern.classEdgeOffsets[state + 1]);
+      nfa.epsilonOffsets.push_back(epsilonBase +
+                                   pattern.epsilonOffsets[state + 1]);
+      nfa.isTerminal.push_back(pattern.isTerminal[state]);
+      nfa.tokenIds.push_back(NO_TOKEN);
+      patternOf.push_back(id);
+    }
+    stateBase += pattern.numStates();
+  }
+
+  nfa.byteClasses = ComputeByteClasses(nfa);
+  currentSet = SparseSet(nfa.numStates());
+  nextSet = SparseSet(nfa.numStates());
+}
+
+/*
+ * Function: PatternSet::buildAhoCorasick
+ *
+ *  Build a trie of the literals, then fill in the missing transitions
+ *  breadth-first from the failure links so that every node has a successor
+ *  on every byte.
+ *
+ *  @param literals The literal of every pattern
+ */
+void PatternSet::buildAhoCorasick(const std::vector<std::string> &literals) {
+  next.assign(256, TRIE_NO_CHILD);
+  depth = {0};
+  patternsEndingAt.resize(1);
+
+  for (int id = 0; id < numPatterns; id++) {
+    int node = 0;
+    for (unsigned char byte : literals[id]) {
+      if (next[node * 256 + byte] == TRIE_NO_CHILD) {
+        next[node * 256 + byte] = depth.size();
+        next.resize(next.size() + 256, TRIE_NO_CHILD);
+        depth.push_back(depth[node] + 1);
+        patternsEndingAt.emplace_back();
+      }
+      node = next[node * 256 + byte];
+    }
+    patternsEndingAt[node].push_back(id);
+  }
+
+  // The failure link of a node is the node of its longest proper suffix
+  std::vector<int32_t> failure(depth.size(), 0);
+  outputLink.assign(depth.size(), -1);
+  std::vector<int32_t> queue;
+  for (int byte = 0; byte < 256; byte++) {
+    if (next[byte] == TRIE_NO_CHILD) {
+      next[byte] = 0;
+    } else {
+      queue.push_back(next[byte]);
+    }
+  }
+
+  for (size_t head = 0; head < queue.size(); head++) {
+    int node = queue[head];
+    for (int byte = 0; byte < 256; byte++) {
+      int32_t &child = next[node * 256 + byte];
+      int32_t suffixChild = next[failure[node] * 256 + byte];
+      if (child == TRIE_NO_CHILD) {
+        child = suffixChild;
+        continue;
+      }
+      failure[child] = suffixChild;
+      outputLink[child] = patternsEndingAt[suffixChild].empty()
+                              ? outputLink[suffixChild]
+                              : suffixChild;
+      queue.push_back(child);
+    }
+  }
+}
+
+/*
+ * Function: PatternSet::markAccepting
+ *
+ *  Record the pattern of every accepting state in the set.
+ *
+ *  @param stateSet Active states of the unioned NFA
+ */
+void PatternSet::markAccepting(const SparseSet &stateSet) {
+  for (uint32_t state : stateSet) {
+    if (nfa.isTerminal[state]) {
+      found[patternOf[state]] = 1;
+    }
+  }
+}
+
+/*
+ * Function: PatternSet::markTrieNode
+ *
+ *  Record every literal that ends at a trie node, including the shorter ones
+ *  reached through output links.
+ *
+ *  @param node Trie node the scan is at
+ */
+void PatternSet::markTrieNode(int node) {
+  if (patternsEndingAt[node].empty()) {
+    node = outputLink[node];
+  }
+  for (; node >= 0; node = outputLink[node]) {
+    for (int id : patternsEndingAt[node]) {
+      found[id] = 1;
+    }
+  }
+}
+
+/*
+ * Function: PatternSet::collectFound
+ *
+ *  @return Ids of the patterns found by the current call in increasing
+ *  order. The marks are cleared for the next call.
+ */
+std::vector<int> PatternSet::collectFound() {
+  std::vector<int> ids;
+  for (int id = 0; id < numPatterns; id++) {
+    if (found[id]) {
+      ids.push_back(id);
+      found[id] = 0;
+    }
+  }
+  return ids;
+}
+
+/*
+ * Function: PatternSet::match
+ *
+ *  Find every pattern that accepts the whole input, in one pass.
+ *
+ *  @param input The input
+ *
+ *  @return Ids of the matching patterns in increasing order
+ */
+std::vector<int> PatternSet::match(std::string_view input) {
+  if (isLiteralSet) {
+    // Walk the trie; a successor of smaller depth means it was left
+    int node = 0;
+    for (size_t i = 0; i < input.size(); i++) {
+      node = next[node * 256 + (unsigned char)input[i]];
+      if (depth[node] != (int)i + 1) {
+        return {};
+      }
+    }
+    return patternsEndingAt[node];
+  }
+
+  currentSet.clear();
+  AddFrozenState(nfa, currentSet, nfa.startState, stack);
+  for (size_t i = 0; i < input.size() && !currentSet.empty(); i++) {
+    nextSet.clear();
+    StepFrozenStates(nfa, currentSet, input[i], nextSet, stack);
+    std::swap(currentSet, nextSet);
+  }
+  markAccepting(currentSet);
+  return collectFound();
+}
+
+/*
+ * Function: PatternSet::search
+ *
+ *  Find every pattern that matches somewhere inside the input, in one pass.
+ *  The NFA starts a new thread at every position; the Aho-Corasick automaton
+ *  needs no threads at all.
+ *
+ *  @param input The input
+ *
+ *  @return Ids of the patterns found in increasing order
+ */
+std::vector<int> PatternSet::search(std::string_view input) {
+  if (isLiteralSet) {
+    int node = 0;
+    markTrieNode(node);
+    for (unsigned char byte : input) {
+      node = next[node * 256 + byte];
+      markTrieNode(node);
+    }
+    return collectFound();
+  }
+
+  currentSet.clear();
+  for (size_t i = 0;; i++) {
+    AddFrozenState(nfa, currentSet, nfa.startState, stack);
+    markAccepting(currentSet);
+    if (i == input.size()) {
+      break;
+    }
+    nextSet.clear();
+    StepFrozenStates(nfa, currentSet, input[i], nextSet, stack);
+    std::swap(currentSet, nextSet);
+  }
+  return collectFound();
+}
@@ -0,0 +1,65 @@
+#ifndef PATTERNSET_H
+#define PATTERNSET_H
+
+#include "frozen.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Trie node that has no child on a byte; only used while building */
+#define TRIE_NO_CHILD -1
+
+/*
+ * class: PatternSet
+ *
+ * Matches an input against many automata at once and reports every pattern
+ * that matches. The patterns are unioned into one NFA whose accepting states
+ * remember the pattern they belong to, so the input is read once however many
+ * patterns there are. When every pattern is a plain literal the set is
+ * compiled into an Aho-Corasick automaton instead, which moves through the
+ * input with one table lookup per byte.
+ *
+ * Pattern ids are positions in the vector the set was built from. A
+ * PatternSet keeps scratch space between calls, so each thread needs its own.
+ *
+ */
+class PatternSet {
+public:
+  explicit PatternSet(const std::vector<const FrozenNFA *> &patterns);
+
+  std::vector<int> match(std::string_view input);
+  std::vector<int> search(std::string_view input);
+
+  int size() const { return numPatterns; }
+  bool literalsOnly() const { return isLiteralSet; }
+
+private:
+  int numPatterns;
+  bool isLiteralSet;
+
+  // Union of the patterns; patternOf names the pattern of every state
+  FrozenNFA nfa;
+  std::vector<uint32_t> patternOf;
+  SparseSet currentSet;
+  SparseSet nextSet;
+  std::vector<uint32_t> stack;
+
+  // Aho-Corasick automaton; node 0 is the root. next is total: a missing
+  // trie child is replaced by the child of the longest proper suffix.
+  std::vector<int32_t> next;
+  std::vector<int32_t> depth;
+  std::vector<std::vector<int>> patternsEndingAt;
+  std::vector<int32_t> outputLink;
+
+  // Patterns found by the current call
+  std::vector<uint8_t> found;
+
+  void buildUnion(const std::vector<const FrozenNFA *> &patterns);
+  void buildAhoCorasick(const std::vector<std::string> &literals);
+  void markAccepting(const SparseSet &stateSet);
+  void markTrieNode(int node);
+  std::vector<int> collectFound();
+};
+
+#endif /* PATTERNSET_H */
@@ -0,0 +1,413 @@
+#include "prefilter.h"
+#include <cstddef>
+#include <cstring>
+
+/* AVX2 paths are built for x86 with GCC or Clang and picked at runtime */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PREFILTER_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(PREFILTER_AVX2)
+#include <immintrin.h>
+#endif
+
+/*
+ * Function: LiteralPrefix
+ *
+ *  Follow the automaton from its start state for as long as every active
+ *  state agrees on a single next byte. Those bytes start every match.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The common prefix of all matches, empty if there is none
+ */
+static std::string LiteralPrefix(const FrozenNFA &nfa) {
+  SparseSet currentSet(nfa.numStates());
+  SparseSet nextSet(nfa.numStates());
+  std::vector<uint32_t> stack;
+  std::string prefix;
+
+  AddFrozenState(nfa, currentSet, nfa.startState, stack);
+  while (prefix.size() < PREFILTER_MAX_LITERAL && !currentSet.empty()) {
+    int symbol = -1;
+    for (uint32_t state : currentSet) {
+      // A match may end here, or a class lets several bytes through
+      if (nfa.isTerminal[state] ||
+          nfa.classEdgeOffsets[state] != nfa.classEdgeOffsets[state + 1]) {
+        return prefix;
+      }
+      for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+           i++) {
+        if (symbol >= 0 && symbol != nfa.edges[i].symbol) {
+          return prefix;
+        }
+        symbol = nfa.edges[i].symbol;
+      }
+    }
+    if (symbol < 0) {
+      return prefix;
+    }
+
+    prefix += (char)symbol;
+    nextSet.clear();
+    StepFrozenStates(nfa, currentSet, symbol, nextSet, stack);
+    std::swap(currentSet, nextSet);
+  }
+  return prefix;
+}
+
+/*
+ * Function: OnEveryPath
+ *
+ *  Check whether every path from the start state to a terminal state passes
+ *  through a state, by searching for a terminal state with it removed.
+ *
+ *  @param nfa The frozen automaton
+ *  @param cut State to remove
+ *
+ *  @return TRUE if no terminal state is reachable without cut
+ */
+static bool OnEveryPath(const FrozenNFA &nfa, uint32_t cut) {
+  if (cut == nfa.startState) {
+    return true;
+  }
+
+  std::vector<uint8_t> seen(nfa.numStates(), 0);
+  std::vector<uint32_t> stack = {nfa.startState};
+  seen[nfa.startState] = 1;
+  seen[cut] = 1;
+  while (!stack.empty()) {
+    uint32_t state = stack.back();
+    stack.pop_back();
+    if (nfa.isTerminal[state]) {
+      return false;
+    }
+
+    auto visit = [&](uint32_t target) {
+      if (!seen[target]) {
+        seen[target] = 1;
+        stack.push_back(target);
+      }
+    };
+    for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+         i++) {
+      visit(nfa.edges[i].target);
+    }
+    for (uint32_t i = nfa.classEdgeOffsets[state];
+         i < nfa.classEdgeOffsets[state + 1]; i++) {
+      visit(nfa.classEdges[i].target);
+    }
+    for (uint32_t i = nfa.epsilonOffsets[state];
+         i < nfa.epsilonOffsets[state + 1]; i++) {
+      visit(nfa.epsilonTargets[i]);
+    }
+  }
+  return true;
+}
+
+/*
+ * Function: ChainLiteral
+ *
+ *  Read the literal spelled by a chain of states that each have exactly one
+ *  transition, a character edge, and are not terminal. Any path entering the
+ *  first state has to read the whole literal.
+ *
+ *  @param nfa The frozen automaton
+ *  @param state First state of the chain
+ *
+ *  @return The literal, empty if state does not start a chain
+ */
+static std::string ChainLiteral(const FrozenNFA &nfa, uint32_t state) {
+  std::string literal;
+  while (literal.size() < PREFILTER_MAX_LITERAL && !nfa.isTerminal[state] &&
+         nfa.edgeOffsets[state + 1] - nfa.edgeOffsets[state] == 1 &&
+         nfa.classEdgeOffsets[state] == nfa.classEdgeOffsets[state + 1] &&
+         nfa.epsilonOffsets[state] == nfa.epsilonOffsets[state + 1]) {
+    const FrozenEdge &edge = nfa.edges[nfa.edgeOffsets[state]];
+    literal += (char)edge.symbol;
+    state = edge.target;
+  }
+  return literal;
+}
+
+/*
+ * Function: RequiredLiteral
+ *
+ *  Find the longest literal that every match contains: a chain of single
+ *  character edges starting at a state that lies on every accepting path.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The literal, empty if none was found
+ */
+static std::string RequiredLiteral(const FrozenNFA &nfa) {
+  std::string best;
+  if (nfa.numStates() > PREFILTER_MAX_STATES) {
+    return best;
+  }
+
+  for (uint32_t state = 0; state < nfa.numStates(); state++) {
+    std::string literal = ChainLiteral(nfa, state);
+    if (literal.size() > best.size() && OnEveryPath(nfa, state)) {
+      best = literal;
+    }
+  }
+  return best;
+}
+
+/*
+ * Function: BuildPrefilter
+ *
+ *  Pick the most selective prefilter the automaton allows. A literal prefix
+ *  of two or more bytes is best since it also gives the start of a match;
+ *  next comes a small set of start bytes, then a literal required anywhere
+ *  in the match. Automata that match the empty string get no prefilter.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The prefilter
+ */
+Prefilter BuildPrefilter(const FrozenNFA &nfa) {
+  Prefilter prefilter;
+  prefilter.kind = Prefilter::NONE;
+  prefilter.numBytes = 0;
+
+  SparseSet startSet(nfa.numStates());
+  SparseSet nextSet(nfa.numStates());
+  std::vector<uint32_t> stack;
+  AddFrozenState(nfa, startSet, nfa.startState, stack);
+  for (uint32_t state : startSet) {
+    if (nfa.isTerminal[state]) {
+      return prefilter;
+    }
+  }
+
+  prefilter.literal = LiteralPrefix(nfa);
+  if (prefilter.literal.size() >= 2) {
+    prefilter.kind = Prefilter::PREFIX;
+    return prefilter;
+  }
+
+  // Bytes of a class behave alike, so one step per class is enough
+  int numBytes = 0;
+  const ByteClasses &byteClasses = nfa.byteClasses;
+  for (int byteClass = 0; byteClass < byteClasses.numClasses; byteClass++) {
+    nextSet.clear();
+    StepFrozenStates(nfa, startSet, byteClasses.representatives[byteClass],
+                     nextSet, stack);
+    if (nextSet.empty()) {
+      continue;
+    }
+    for (int byte = 0; byte < 256; byte++) {
+      if (byteClasses.map[byte] != byteClass) {
+        continue;
+      }
+      if (numBytes == PREFILTER_MAX_BYTES) {
+        numBytes++;
+        break;
+      }
+      prefilter.bytes[numBytes++] = byte;
+    }
+    if (numBytes > PREFILTER_MAX_BYTES) {
+      break;
+    }
+  }
+  if (numBytes > 0 && numBytes <= PREFILTER_MAX_BYTES) {
+    prefilter.kind = Prefilter::START_BYTES;
+    prefilter.numBytes = numBytes;
+    return prefilter;
+  }
+
+  prefilter.literal = RequiredLiteral(nfa);
+  if (!prefilter.literal.empty()) {
+    prefilter.kind = Prefilter::REQUIRED;
+  }
+  return prefilter;
+}
+
+#if defined(PREFILTER_AVX2)
+/*
+ * Function: HasAVX2
+ *
+ *  @return TRUE if the CPU running the program supports AVX2. The build
+ *  does not assume it, so the AVX2 paths are only taken when this says so.
+ */
+static bool HasAVX2() {
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+
+/*
+ * Function: FindBytesAVX2
+ *
+ *  AVX2 part of FindBytes: scans [first, last) 32 bytes at a time and
+ *  leaves first at the tail it could not cover.
+ *
+ *  @return Pointer to the byte found, or nullptr if the blocks had none
+ */
+__attribute__((target("avx2"))) static const char *
+FindBytesAVX2(const char *&first, const char *last, const unsigned char *bytes,
+              int numBytes) {
+  __m256i wanted[PREFILTER_MAX_BYTES];
+  for (int i = 0; i < numBytes; i++) {
+    wanted[i] = _mm256_set1_epi8(bytes[i]);
+  }
+  for (; last - first >= 32; first += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)first);
+    __m256i found = _mm256_cmpeq_epi8(block, wanted[0]);
+    for (int i = 1; i < numBytes; i++) {
+      found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, wanted[i]));
+    }
+    unsigned mask = _mm256_movemask_epi8(found);
+    if (mask != 0) {
+      return first + __builtin_ctz(mask);
+    }
+  }
+  return nullptr;
+}
+
+/*
+ * Function: FindLiteralAVX2
+ *
+ *  AVX2 part of FindLiteral: checks the starts in [first, end) 32 at a time
+ *  and leaves first at the starts it could not cover.
+ *
+ *  @return Pointer to the occurrence, or nullptr if the blocks had none
+ */
+__attribute__((target("avx2"))) static const char *
+FindLiteralAVX2(const char *&first, const char *end,
+                const std::string &literal) {
+  size_t length = literal.size();
+  __m256i head = _mm256_set1_epi8(literal[0]);
+  __m256i tail = _mm256_set1_epi8(literal[length - 1]);
+  for (; end - first >= 32; first += 32) {
+    __m256i headBlock = _mm256_loadu_si256((const __m256i *)first);
+    __m256i tailBlock =
+        _mm256_loadu_si256((const __m256i *)(first + length - 1));
+    __m256i found = _mm256_and_si256(_mm256_cmpeq_epi8(headBlock, head),
+                                     _mm256_cmpeq_epi8(tailBlock, tail));
+    unsigned mask = _mm256_movemask_epi8(found);
+    while (mask != 0) {
+      const char *candidate = first + __builtin_ctz(mask);
+      if (memcmp(candidate + 1, literal.data() + 1, length - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return nullptr;
+}
+#endif
+
+/*
+ * Function: FindBytes
+ *
+ *  Find the first byte in [first, last) that is one of bytes. Compares 32
+ *  bytes at a time when the CPU has AVX2, then 16 at a time with SSE2, and
+ *  finishes the tail one byte at a time.
+ *
+ *  @param first Start of the range
+ *  @param last End of the range
+ *  @param bytes Bytes to look for
+ *  @param numBytes Number of bytes, 1 to PREFILTER_MAX_BYTES
+ *
+ *  @return Pointer to the byte found, or last if there is none
+ */
+const char *FindBytes(const char *first, const char *last,
+                      const unsigned char *bytes, int numBytes) {
+#if defined(PREFILTER_AVX2)
+  if (HasAVX2()) {
+    const char *found = FindBytesAVX2(first, last, bytes, numBytes);
+    if (found != nullptr) {
+      return found;
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  __m128i wanted16[PREFILTER_MAX_BYTES];
+  for (int i = 0; i < numBytes; i++) {
+    wanted16[i] = _mm_set1_epi8(bytes[i]);
+  }
+  for (; last - first >= 16; first += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)first);
+    __m128i found = _mm_cmpeq_epi8(block, wanted16[0]);
+    for (int i = 1; i < numBytes; i++) {
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(block, wanted16[i]));
+    }
+    unsigned mask = _mm_movemask_epi8(found);
+    if (mask != 0) {
+      return first + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; first != last; first++) {
+    for (int i = 0; i < numBytes; i++) {
+      if ((unsigned char)*first == bytes[i]) {
+        return first;
+      }
+    }
+  }
+  return last;
+}
+
+/*
+ * Function: FindLiteral
+ *
+ *  Find the first occurrence of a literal in [first, last). The vector paths
+ *  compare the first and last byte of the literal at 32 or 16 positions at
+ *  once and only verify the positions where both agree, so most of the input
+ *  is never looked at byte by byte.
+ *
+ *  @param first Start of the range
+ *  @param last End of the range
+ *  @param literal Non-empty literal to look for
+ *
+ *  @return Pointer to the start of the occurrence, or last if there is none
+ */
+const char *FindLiteral(const char *first, const char *last,
+                        const std::string &literal) {
+  size_t length = literal.size();
+  if (length == 1) {
+    return FindBytes(first, last, (const unsigned char *)literal.data(), 1);
+  }
+  if (last - first < (ptrdiff_t)length) {
+    return last;
+  }
+
+  // Occurrences start before end
+  const char *end = last - length + 1;
+#if defined(PREFILTER_AVX2)
+  if (HasAVX2()) {
+    const char *found = FindLiteralAVX2(first, end, literal);
+    if (found != nullptr) {
+      return found;
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  __m128i head16 = _mm_set1_epi8(literal[0]);
+  __m128i tail16 = _mm_set1_epi8(literal[length - 1]);
+  for (; end - first >= 16; first += 16) {
+    __m128i headBlock = _mm_loadu_si128((const __m128i *)first);
+    __m128i tailBlock = _mm_loadu_si128((const __m128i *)(first + length - 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(headBlock, head16), _mm_cmpeq_epi8(tailBlock, tail16)));
+    while (mask != 0) {
+      const char *candidate = first + __builtin_ctz(mask);
+      if (memcmp(candidate + 1, literal.data() + 1, length - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; first != end; first++) {
+    if (*first == literal[0] && memcmp(first, literal.data(), length) == 0) {
+      return first;
+    }
+  }
+  return last;
+}
@@ -0,0 +1,44 @@
+#ifndef PREFILTER_H
+#define PREFILTER_H
+
+#include "frozen.h"
+#include <string>
+
+/* Longest literal the prefilter extracts from an automaton */
+#define PREFILTER_MAX_LITERAL 32
+
+/* Most distinct start bytes the prefilter scans for at once */
+#define PREFILTER_MAX_BYTES 3
+
+/* Automata above this size skip the required-literal analysis */
+#define PREFILTER_MAX_STATES 4096
+
+/*
+ * struct: Prefilter
+ *
+ * Cheap test run over the input before the automaton, found by looking at
+ * the automaton once when it is built.
+ *
+ * @field kind: PREFIX if every match starts with literal, START_BYTES if every
+ * match starts with one of bytes, REQUIRED if every match contains literal
+ * somewhere, NONE if nothing useful was found (e.g. the empty string matches).
+ * @field literal: The literal for PREFIX and REQUIRED.
+ * @field bytes: The possible first bytes for START_BYTES.
+ * @field numBytes: Number of entries in bytes.
+ *
+ */
+struct Prefilter {
+  enum { NONE, PREFIX, START_BYTES, REQUIRED } kind;
+  std::string literal;
+  unsigned char bytes[PREFILTER_MAX_BYTES];
+  int numBytes;
+};
+
+/* Function Prototypes */
+Prefilter BuildPrefilter(const FrozenNFA &nfa);
+const char *FindBytes(const char *first, const char *last,
+                      const unsigned char *bytes, int numBytes);
+const char *FindLiteral(const char *first, const char *last,
+                        const std::string &literal);
+
+#endif /* PREFILTER_H */
@@ -1,18 +1,17 @@
 #include "regex.h"
 
-std::pair<Node *, Node *> LiteralNFA(std::string acceptable_chars,
-                                     std::string identifyingSymbol) {
-
-  struct Node *start_node = new Node();
+NfaHandle LiteralNFA(std::string acceptable_chars,
+                     std::string identifyingSymbol) {
+  auto arena = std::make_shared<NfaArena>();
+  struct Node *start_node = arena->newNode();
   struct Node *prev_node = start_node;
-  struct Node *end_node;
-  struct Node *current_node;
+  struct Node *current_node = start_node;
 
   start_node->tokenIdentifier = identifyingSymbol;
   // Create a new node.
   // Make a transition from prev_node to new_node with regex_expression[i]
   for (char c : acceptable_chars) {
-    current_node = new Node();
+    current_node = arena->newNode();
     current_node->isTerminalNode = false;
     current_node->tokenIdentifier = identifyingSymbol;
     Label label = Label();
@@ -22,17 +21,16 @@ std::pair<Node *, Node *> LiteralNFA(std::string acceptable_chars,
     prev_node = current_node;
   }
   current_node->isTerminalNode = true;
-  end_node = current_node;
 
-  return {start_node, end_node};
+  return {arena, start_node, current_node};
 }
 
-std::pair<Node *, Node *> KleeneStarNFA(std::pair<Node *, Node *> nfa) {
+NfaHandle KleeneStarNFA(NfaHandle nfa) {
   // Create new initial nodes for empty string
-  Node *new_start = new Node();
-  Node *new_accept = new Node();
-  new_start->tokenIdentifier = nfa.first->tokenIdentifier;
-  new_accept->tokenIdentifier = nfa.second->tokenIdentifier;
+  Node *new_start = nfa.arena->newNode();
+  Node *new_accept = nfa.arena->newNode();
+  new_start->tokenIdentifier = nfa.start->tokenIdentifier;
+  new_accept->tokenIdentifier = nfa.accept->tokenIdentifier;
   new_accept->isTerminalNode = true;
   Label epsilon;
   epsilon.type = Label::EPSILON;
@@ -41,47 +39,62 @@ std::pair<Node *, Node *> KleeneStarNFA(std::pair<Node *, Node *> nfa) {
   new_start->transitions.push_back({epsilon, new_accept});
 
   // Inputted NFA
-  new_start->transitions.push_back({epsilon, nfa.first});
+  new_start->transitions.push_back({epsilon, nfa.start});
 
   // Add epsilon back to start for repetition
-  nfa.second->isTerminalNode = false; // Old accept not terminal for safety
-  nfa.second->transitions.push_back({epsilon, nfa.first});
-  nfa.second->transitions.push_back({epsilon, new_accept});
+  nfa.accept->isTerminalNode = false; // Old accept not terminal for safety
+  nfa.accept->transitions.push_back({epsilon, nfa.start});
+  nfa.accept->transitions.push_back({epsilon, new_accept});
 
-  return {new_start, new_accept};
+  return {nfa.arena, new_start, new_accept};
 }
 
-std::pair<Node *, Node *> BracketNFA(std::vector<char> accepting_chars,
-                                     std::string identifyingSymbol) {
-  struct Node *start_node = new Node();
-  struct Node *end_node = new Node();
+// Single edge from start to end accepting any byte of the class
+static NfaHandle ClassNFA(const CharClass &char_class,
+                          std::string identifyingSymbol) {
+  auto arena = std::make_shared<NfaArena>();
+  struct Node *start_node = arena->newNode();
+  struct Node *end_node = arena->newNode();
 
-  for (char chr : accepting_chars) {
-    Label label = Label();
-    label.type = Label::CHAR;
-    label.value = chr;
-    start_node->transitions.push_back({label, end_node});
-    start_node->tokenIdentifier = identifyingSymbol;
-  }
+  Label label = Label();
+  label.type = Label::CLASS;
+  label.charClass = arena->newCharClass(char_class);
+  start_node->transitions.push_back({label, end_node});
+  start_node->tokenIdentifier = identifyingSymbol;
 
   end_node->tokenIdentifier = identifyingSymbol;
   end_node->isTerminalNode = true;
-  return {start_node, end_node};
+  return {arena, start_node, end_node};
+}
+
+NfaHandle BracketNFA(std::vector<char> accepting_chars,
+                     std::string identifyingSymbol) {
+  CharClass char_class = CharClass();
+  for (char chr : accepting_chars) {
+    char_class.add(chr);
+  }
+  return ClassNFA(char_class, identifyingSymbol);
+}
+
+// Any single character from low to high (inclusive), e.g. (a-z)
+NfaHandle RangeNFA(char low, char high, std::string identifyingSymbol) {
+  CharClass char_class = CharClass();
+  char_class.addRange(low, high);
+  return ClassNFA(char_class, identifyingSymbol);
 }
 
-std::pair<Node *, Node *> ConcatNFA(std::pair<Node *, Node *> nfa1,
-                                    std::pair<Node *, Node *> nfa2) {
+NfaHandle ConcatNFA(NfaHandle nfa1, NfaHandle nfa2) {
   Label label = Label();
   label.type = Label::EPSILON;
-  nfa1.second->isTerminalNode = false;
-  nfa1.second->transitions.push_back({label, nfa2.second});
-  return {nfa1.first, nfa2.second};
+  nfa1.accept->isTerminalNode = false;
+  nfa1.accept->transitions.push_back({label, nfa2.start});
+  return {MergeArenas(nfa1, nfa2), nfa1.start, nfa2.accept};
 }
 
 // Definition of PlusNFA for chars (assuming not passed a literal)
-std::pair<Node *, Node *> PlusNFA(std::vector<char> accepting_chars,
-                                  std::string identifyingSymbol) {
-  std::pair<Node *, Node *> first_bracket_nfa, second_bracket_nfa, final_nfa;
+NfaHandle PlusNFA(std::vector<char> accepting_chars,
+                  std::string identifyingSymbol) {
+  NfaHandle first_bracket_nfa, second_bracket_nfa, final_nfa;
   first_bracket_nfa = BracketNFA(accepting_chars, identifyingSymbol);
   second_bracket_nfa = BracketNFA(accepting_chars, identifyingSymbol);
 
@@ -91,32 +104,43 @@ std::pair<Node *, Node *> PlusNFA(std::vector<char> accepting_chars,
 }
 
 // PlusNFA when a predefined NFA is passed, such as LiteralNFA
-std::pair<Node *, Node *> PlusNFA(std::pair<Node *, Node *> nfa) {
+NfaHandle PlusNFA(NfaHandle nfa) {
   // For A+, the NFA must match one occurrence of A (which is ensured by the
   // given NFA) and then allow additional repetitions of A. This is achieved by
   // adding an epsilon transition from the terminal node back to the start node.
   Label label;
   label.type = Label::EPSILON;
-  nfa.second->transitions.push_back({label, nfa.first});
+  nfa.accept->transitions.push_back({label, nfa.start});
   return nfa;
 }
 
-Node *ThompsonNFA(std::vector<std::pair<Node *, Node *>> nfas) {
-  struct Node *start_node = new Node();
+NfaHandle ThompsonNFA(std::vector<NfaHandle> nfas) {
+  // The largest arena takes over the chunks of the others
+  auto arena = std::make_shared<NfaArena>();
+  for (auto &nfa : nfas) {
+    if (nfa.arena->chunkCount() > arena->chunkCount()) {
+      arena = nfa.arena;
+    }
+  }
+  for (auto &nfa : nfas) {
+    arena->absorb(*nfa.arena);
+  }
+
+  struct Node *start_node = arena->newNode();
   Label label = Label();
   label.type = Label::EPSILON;
 
   for (auto nfa : nfas) {
-    start_node->transitions.push_back({label, nfa.first});
+    start_node->transitions.push_back({label, nfa.start});
   }
-  return start_node;
+  return {arena, start_node, nullptr};
 }
 
-std::pair<Node *, Node *> OptionalNFA(std::pair<Node *, Node *> nfa) {
+NfaHandle OptionalNFA(NfaHandle nfa) {
   // Add an epsilon transition from the start node to the terminal node.
   // This allows the NFA to skip the contained expression.
   Label label;
   label.type = Label::EPSILON;
-  nfa.first->transitions.push_back({label, nfa.second});
+  nfa.start->transitions.push_back({label, nfa.accept});
   return nfa;
 }
@@ -0,0 +1,461 @@
+#include "search.h"
+#include <algorithm>
+
+/*
+ * Function: ReverseNFA
+ *
+ *  Build the NFA of the reversed language: every transition is flipped, a
+ *  new start state has epsilon transitions to the old terminal states, and
+ *  the old start state becomes the only terminal state. Running it backwards
+ *  from the end of a match finds where the match starts.
+ *
+ *  @param nfa The frozen automaton
+ *
+ *  @return The reversed automaton, with one more state than nfa
+ */
+FrozenNFA ReverseNFA(const FrozenNFA &nfa) {
+  uint32_t numStates = nfa.numStates();
+  FrozenNFA reversed;
+  reversed.startState = numStates;
+  reversed.classes = nfa.classes;
+  reversed.tokenNames = nfa.tokenNames;
+  reversed.byteClasses = nfa.byteClasses;
+
+  // Count the transitions entering every state, they become its out edges
+  reversed.edgeOffsets.assign(numStates + 2, 0);
+  reversed.classEdgeOffsets.assign(numStates + 2, 0);
+  reversed.epsilonOffsets.assign(numStates + 2, 0);
+  for (uint32_t state = 0; state < numStates; state++) {
+    for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+         i++) {
+      reversed.edgeOffsets[nfa.edges[i].target + 1]++;
+    }
+    for (uint32_t i = nfa.classEdgeOffsets[state];
+         i < nfa.classEdgeOffsets[state + 1]; i++) {
+      reversed.classEdgeOffsets[nfa.classEdges[i].target + 1]++;
+    }
+    for (uint32_t i = nfa.epsilonOffsets[state];
+         i < nfa.epsilonOffsets[state + 1]; i++) {
+      reversed.epsilonOffsets[nfa.epsilonTargets[i] + 1]++;
+    }
+    if (nfa.isTerminal[state]) {
+      reversed.epsilonOffsets[numStates + 1]++;
+    }
+  }
+  for (uint32_t state = 1; state <= numStates + 1; state++) {
+    reversed.edgeOffsets[state] += reversed.edgeOffsets[state - 1];
+    reversed.classEdgeOffsets[state] += reversed.classEdgeOffsets[state - 1];
+    reversed.epsilonOffsets[state] += reversed.epsilonOffsets[state - 1];
+  }
+
+  reversed.edges.resize(nfa.edges.size());
+  reversed.classEdges.resize(nfa.classEdges.size());
+  reversed.epsilonTargets.resize(reversed.epsilonOffsets[numStates + 1]);
+  std::vector<uint32_t> edgeCursor(reversed.edgeOffsets.begin(),
+                                   reversed.edgeOffsets.end() - 1);
+  std::vector<uint32_t> classCursor(reversed.classEdgeOffsets.begin(),
+                                    reversed.classEdgeOffsets.end() - 1);
+  std::vector<uint32_t> epsilonCursor(reversed.epsilonOffsets.begin(),
+                                      reversed.epsilonOffsets.end() - 1);
+  for (uint32_t state = 0; state < numStates; state++) {
+    for (uint32_t i = nfa.edgeOffsets[state]; i < nfa.edgeOffsets[state + 1];
+         i++) {
+      const FrozenEdge &edge = nfa.edges[i];
+      reversed.edges[edgeCursor[edge.target]++] = {edge.symbol, state};
+    }
+    for (uint32_t i = nfa.classEdgeOffsets[state];
+         i < nfa.classEdgeOffsets[state + 1]; i++) {
+      const FrozenClassEdge &classEdge = nfa.classEdges[i];
+      reversed.classEdges[classCursor[classEdge.target]++] = {classEdge.classId,
+                                                              state};
+    }
+    for (uint32_t i = nfa.epsilonOffsets[state];
+         i < nfa.epsilonOffsets[state + 1]; i++) {
+      reversed.epsilonTargets[epsilonCursor[nfa.epsilonTargets[i]]++] = state;
+    }
+    if (nfa.isTerminal[state]) {
+      reversed.epsilonTargets[epsilonCursor[numStates]++] = state;
+    }
+  }
+
+  // Character edges have to stay sorted by symbol within a state
+  for (uint32_t state = 0; state < numStates; state++) {
+    std::stable_sort(reversed.edges.begin() + reversed.edgeOffsets[state],
+                     reversed.edges.begin() + reversed.edgeOffsets[state + 1],
+                     [](const FrozenEdge &lhs, const FrozenEdge &rhs) {
+                       return lhs.symbol < rhs.symbol;
+                     });
+  }
+
+  reversed.isTerminal.assign(numStates + 1, 0);
+  reversed.isTerminal[nfa.startState] = 1;
+  reversed.tokenIds = nfa.tokenIds;
+  reversed.tokenIds.push_back(NO_TOKEN);
+  return reversed;
+}
+
+/*
+ * Function: Searcher::Searcher
+ *
+ *  Set up the prefilter and the scratch space. The reversed NFA is only
+ *  built by the first search that needs it.
+ *
+ *  @param frozenNFA NFA to search with; the Searcher keeps its own copy
+ */
+Searcher::Searcher(const FrozenNFA &frozenNFA)
+    : nfa(frozenNFA), hasReversed(false),
+      prefilter(BuildPrefilter(frozenNFA)), searchStats({0, 0}),
+      currentSet(frozenNFA.numStates() + 1), nextSet(frozenNFA.numStates() + 1),
+      currentStarts(frozenNFA.numStates()), nextStarts(frozenNFA.numStates()) {}
+
+/*
+ * Function: Searcher::canMatch
+ *
+ *  Rule out a whole search up front when the prefilter names a literal every
+ *  match contains and the rest of the input does not contain it.
+ *
+ *  @param startIndex Index the search starts at
+ *  @param input The input string
+ *
+ *  @return FALSE if no match can exist at or after startIndex
+ */
+bool Searcher::canMatch(int startIndex, std::string_view input) {
+  if (prefilter.kind != Prefilter::REQUIRED) {
+    return true;
+  }
+
+  const char *first = input.data() + startIndex;
+  const char *last = input.data() + input.size();
+  searchStats.prefilterScans++;
+  if (FindLiteral(first, last, prefilter.literal) == last) {
+    searchStats.bytesSkipped += last - first;
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Function: Searcher::skipAhead
+ *
+ *  Move to the next position a match can start at, scanning with the
+ *  prefix literal or the start bytes of the prefilter. Only called while no
+ *  thread is active, so skipped positions cannot be inside a match.
+ *
+ *  @param index Position of the next input byte
+ *  @param input The input string
+ *
+ *  @return The next possible start, or -1 if there is none
+ */
+int Searcher::skipAhead(int index, std::string_view input) {
+  const char *first = input.data() + index;
+  const char *last = input.data() + input.size();
+  const char *found;
+  if (prefilter.kind == Prefilter::PREFIX) {
+    found = FindLiteral(first, last, prefilter.literal);
+  } else if (prefilter.kind == Prefilter::START_BYTES) {
+    found = FindBytes(first, last, prefilter.bytes, prefilter.numBytes);
+  } else {
+    return index;
+  }
+
+  searchStats.prefilterScans++;
+  searchStats.bytesSkipped += found - first;
+  if (found == last) {
+    return -1;
+  }
+  return found - input.data();
+}
+
+/*
+ * Function: Searcher::scanStart
+ *
+ *  Run the reversed NFA backwards from the end of a match and return the
+ *  leftmost position a match ending there can start at.
+ *
+ *  @param end End of a known match
+ *  @param startIndex Matches may not start before this index
+ *  @param input The input string
+ *
+ *  @return Start of the match
+ */
+int Searcher::scanStart(int end, int startIndex, std::string_view input) {
+  if (!hasReversed) {
+    reversed = ReverseNFA(nfa);
+    hasReversed = true;
+  }
+
+  int start = end;
+  currentSet.clear();
+  AddFrozenState(reversed, currentSet, reversed.startState, stack);
+  for (int index = end; !currentSet.empty(); index--) {
+    for (uint32_t state : currentSet) {
+      if (reversed.isTerminal[state]) {
+        start = index;
+        break;
+      }
+    }
+    if (index == startIndex) {
+      break;
+    }
+
+    nextSet.clear();
+    StepFrozenStates(reversed, currentSet, input[index - 1], nextSet, stack);
+    std::swap(currentSet, nextSet);
+  }
+  return start;
+}
+
+/*
+ * Function: Searcher::earliest
+ *
+ *  Find the match that ends first. A forward scan that starts a new thread
+ *  at every position stops at the first accept, which fixes the end without
+ *  tracking starts; the reversed NFA then finds the start.
+ *
+ *  @param startIndex Index to start scanning at
+ *  @param input The input string
+ *
+ *  @return The match, or {-1, -1} if there is none
+ */
+Match Searcher::earliest(int startIndex, std::string_view input) {
+  if (!canMatch(startIndex, input)) {
+    return {-1, -1};
+  }
+
+  currentSet.clear();
+  for (int index = startIndex;; index++) {
+    if (currentSet.empty()) {
+      index = skipAhead(index, input);
+      if (index < 0) {
+        return {-1, -1};
+      }
+    }
+    AddFrozenState(nfa, currentSet, nfa.startState, stack);
+    for (uint32_t state : currentSet) {
+      if (nfa.isTerminal[state]) {
+        return {scanStart(index, startIndex, input), index};
+      }
+    }
+    if (index == (int)input.size()) {
+      return {-1, -1};
+    }
+
+    nextSet.clear();
+    StepFrozenStates(nfa, currentSet, input[index], nextSet, stack);
+    std::swap(currentSet, nextSet);
+  }
+}
+
+/*
+ * Function: Searcher::leftmostLongest
+ *
+ *  Find the match that starts leftmost, and of those the longest. Every
+ *  active state remembers the position its thread started at. Threads are
+ *  added in order of their start and a state keeps the first thread that
+ *  reaches it, so the set stays sorted by start and the first accepting
+ *  state has the leftmost start. Once a match is known no new threads are
+ *  started and threads starting to its right are dropped; the scan ends when
+ *  no thread is left that could extend or precede it.
+ *
+ *  @param startIndex Index to start scanning at
+ *  @param input The input string
+ *
+ *  @return The match, or {-1, -1} if there is none
+ */
+Match Searcher::leftmostLongest(int startIndex, std::string_view input) {
+  Match match = {-1, -1};
+  if (!canMatch(startIndex, input)) {
+    return match;
+  }
+
+  currentSet.clear();
+  for (int index = startIndex;; index++) {
+    if (match.start < 0) {
+      if (currentSet.empty()) {
+        index = skipAhead(index, input);
+        if (index < 0) {
+          return match;
+        }
+      }
+      uint32_t added = currentSet.size();
+      AddFrozenState(nfa, currentSet, nfa.startState, stack);
+      for (const uint32_t *state = currentSet.begin() + added;
+           state != currentSet.end(); state++) {
+        currentStarts[*state] = index;
+      }
+    }
+
+    for (uint32_t state : currentSet) {
+      if (nfa.isTerminal[state]) {
+        if (match.start < 0 || currentStarts[state] <= match.start) {
+          match = {currentStarts[state], index};
+        }
+        break;
+      }
+    }
+    if (index == (int)input.size()) {
+      break;
+    }
+
+    nextSet.clear();
+    for (uint32_t state : currentSet) {
+      int start = currentStarts[state];
+      if (match.start >= 0 && start > match.start) {
+        break;
+      }
+      uint32_t added = nextSet.size();
+      StepFrozenState(nfa, state, input[index], nextSet, stack);
+      for (const uint32_t *target = nextSet.begin() + added;
+           target != nextSet.end(); target++) {
+        nextStarts[*target] = start;
+      }
+    }
+    std::swap(currentSet, nextSet);
+    std::swap(currentStarts, nextStarts);
+
+    if (match.start >= 0 && currentSet.empty()) {
+      break;
+    }
+  }
+  return match;
+}
+
+/*
+ * Function: MatchIterator::MatchIterator
+ *
+ *  @param searcher Searcher to find the matches with
+ *  @param input The input string
+ *  @param startIndex Index to start scanning at
+ */
+MatchIterator::MatchIterator(Searcher &searcher, std::string_view input,
+                             int startIndex)
+    : searcher(searcher), input(input), position(startIndex) {}
+
+/*
+ * Function: MatchIterator::next
+ *
+ *  Find the next match after the previous one.
+ *
+ *  @param match Receives the match
+ *
+ *  @return TRUE if a match was found, FALSE once the input is exhausted
+ */
+bool MatchIterator::next(Match &match) {
+  if (position > (int)input.size()) {
+    return false;
+  }
+
+  match = searcher.leftmostLongest(position, input);
+  if (match.start < 0) {
+    position = input.size() + 1;
+    return false;
+  }
+  position = match.end > match.start ? match.end : match.end + 1;
+  return true;
+}
+
+/*
+ * Function: FirstMatchNFA
+ *  Find the match that ends first anywhere in the input, starting the scan at
+ *  startIndex. Of the matches ending there, the one starting leftmost is
+ *  returned.
+ *
+ * @param nfa
+ * @param startIndex
+ * @param input
+ * @param stats If not null, receives the prefilter statistics
+ *
+ * @return The match, or {-1, -1} if there is none.
+ */
+Match FirstMatchNFA(const FrozenNFA &nfa, int startIndex,
+                    std::string_view input, SearchStats *stats) {
+  Searcher searcher(nfa);
+  Match match = searcher.earliest(startIndex, input);
+  if (stats != nullptr) {
+    *stats = searcher.stats();
+  }
+  return match;
+}
+
+/*
+ * Function: SearchNFA
+ *  Find the leftmost-longest match anywhere in the input, starting the scan
+ *  at startIndex.
+ *
+ * @param nfa
+ * @param startIndex
+ * @param input
+ * @param stats If not null, receives the prefilter statistics
+ *
+ * @return The match, or {-1, -1} if there is none.
+ */
+Match SearchNFA(const FrozenNFA &nfa, int startIndex, std::string_view input,
+                SearchStats *stats) {
+  Searcher searcher(nfa);
+  return SearchNFA(searcher, startIndex, input, stats);
+}
+
+/*
+ * Function: SearchNFA
+ *  Find the leftmost-longest match with a Searcher built earlier, so its
+ *  prefilter and reversed NFA are reused.
+ *
+ * @param searcher
+ * @param startIndex
+ * @param input
+ * @param stats If not null, receives the prefilter statistics of this search
+ *
+ * @return The match, or {-1, -1} if there is none.
+ */
+Match SearchNFA(Searcher &searcher, int startIndex, std::string_view input,
+                SearchStats *stats) {
+  searcher.resetStats();
+  Match match = searcher.leftmostLongest(startIndex, input);
+  if (stats != nullptr) {
+    *stats = searcher.stats();
+  }
+  return match;
+}
+
+/*
+ * Function: FindAllNFA
+ *  Collect every non-overlapping leftmost-longest match, scanning the input
+ *  from left to right.
+ *
+ * @param nfa
+ * @param input
+ * @param stats If not null, receives the prefilter statistics
+ *
+ * @return The matches in order of their start.
+ */
+std::vector<Match> FindAllNFA(const FrozenNFA &nfa, std::string_view input,
+                              SearchStats *stats) {
+  Searcher searcher(nfa);
+  return FindAllNFA(searcher, input, stats);
+}
+
+/*
+ * Function: FindAllNFA
+ *  Collect every non-overlapping leftmost-longest match with a Searcher
+ *  built earlier.
+ *
+ * @param searcher
+ * @param input
+ * @param stats If not null, receives the prefilter statistics of this scan
+ *
+ * @return The matches in order of their start.
+ */
+std::vector<Match> FindAllNFA(Searcher &searcher, std::string_view input,
+                              SearchStats *stats) {
+  searcher.resetStats();
+  MatchIterator iterator(searcher, input);
+  std::vector<Match> matches;
+  Match match;
+  while (iterator.next(match)) {
+    matches.push_back(match);
+  }
+  if (stats != nullptr) {
+    *stats = searcher.stats();
+  }
+  return matches;
+}
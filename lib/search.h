@@ -0,0 +1,98 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "frozen.h"
+#include "prefilter.h"
+#include <string>
+#include <vector>
+
+/*
+ * struct: SearchStats
+ *
+ * Work done by the prefilter of a Searcher.
+ *
+ * @field prefilterScans: Number of times the prefilter scanned the input.
+ * @field bytesSkipped: Input bytes the automaton never had to look at.
+ *
+ */
+struct SearchStats {
+  size_t prefilterScans;
+  size_t bytesSkipped;
+};
+
+/*
+ * class: Searcher
+ *
+ * Finds matches of an NFA inside a larger input instead of testing the whole
+ * input. Every position is a possible start, so the search is unanchored.
+ * Whenever no match is in progress a prefilter skips ahead to the next place
+ * a match can start. The Searcher keeps its own copy of the NFA and the
+ * scratch space of the simulation, so repeated searches do not allocate.
+ * Building one copies the NFA and computes the prefilter, so a Searcher is
+ * best built once per automaton and reused.
+ *
+ */
+class Searcher {
+public:
+  explicit Searcher(const FrozenNFA &frozenNFA);
+
+  Match earliest(int startIndex, std::string_view input);
+  Match leftmostLongest(int startIndex, std::string_view input);
+
+  const SearchStats &stats() const { return searchStats; }
+  void resetStats() { searchStats = {0, 0}; }
+
+private:
+  FrozenNFA nfa;
+  FrozenNFA reversed;
+  bool hasReversed;
+  Prefilter prefilter;
+  SearchStats searchStats;
+
+  // Scratch space; the starts vectors hold where each active state began
+  SparseSet currentSet;
+  SparseSet nextSet;
+  std::vector<int> currentStarts;
+  std::vector<int> nextStarts;
+  std::vector<uint32_t> stack;
+
+  int scanStart(int end, int startIndex, std::string_view input);
+  bool canMatch(int startIndex, std::string_view input);
+  int skipAhead(int index, std::string_view input);
+};
+
+/*
+ * class: MatchIterator
+ *
+ * Walks the non-overlapping leftmost-longest matches of an input from left
+ * to right. An empty match moves the scan one byte forward so the iteration
+ * always ends. The input must outlive the iterator.
+ *
+ */
+class MatchIterator {
+public:
+  MatchIterator(Searcher &searcher, std::string_view input,
+                int startIndex = 0);
+
+  bool next(Match &match);
+
+private:
+  Searcher &searcher;
+  std::string_view input;
+  int position;
+};
+
+/* Function Prototypes */
+FrozenNFA ReverseNFA(const FrozenNFA &nfa);
+Match FirstMatchNFA(const FrozenNFA &nfa, int startIndex,
+                    std::string_view input, SearchStats *stats = nullptr);
+Match SearchNFA(const FrozenNFA &nfa, int startIndex, std::string_view input,
+                SearchStats *stats = nullptr);
+Match SearchNFA(Searcher &searcher, int startIndex, std::string_view input,
+                SearchStats *stats = nullptr);
+std::vector<Match> FindAllNFA(const FrozenNFA &nfa, std::string_view input,
+                              SearchStats *stats = nullptr);
+std::vector<Match> FindAllNFA(Searcher &searcher, std::string_view input,
+                              SearchStats *stats = nullptr);
+
+#endif /* SEARCH_H */
@@ -0,0 +1,232 @@
+#include "stream.h"
+#include <cstdio>
+
+/*
+ * Function: StreamMatcher::StreamMatcher
+ *
+ *  Build a matcher that simulates a frozen NFA.
+ *
+ *  @param nfa The automaton to match with
+ */
+StreamMatcher::StreamMatcher(const FrozenNFA &nfa)
+    : engine(Engine::NFA), nfa(&nfa), dfa(nullptr),
+      currentSet(nfa.numStates()), nextSet(nfa.numStates()) {
+  reset();
+}
+
+/*
+ * Function: StreamMatcher::StreamMatcher
+ *
+ *  Build a matcher that walks a compiled DFA table.
+ *
+ *  @param dfa The automaton to match with
+ */
+StreamMatcher::StreamMatcher(const DFA &dfa)
+    : engine(Engine::DFA), nfa(nullptr), dfa(&dfa), currentSet(0),
+      nextSet(0) {
+  reset();
+}
+
+/*
+ * Function: StreamMatcher::StreamMatcher
+ *
+ *  Build a matcher that uses a lazily built DFA. The matcher copies the
+ *  LazyDFA, states cached so far included, and grows its own cache from there.
+ *
+ *  @param dfa The automaton to match with
+ */
+StreamMatcher::StreamMatcher(const LazyDFA &dfa)
+    : engine(Engine::LazyDFA), nfa(nullptr), dfa(nullptr),
+      lazyDFA(std::make_unique<LazyDFA>(dfa)),
+      currentSet(dfa.automaton().numStates()),
+      nextSet(dfa.automaton().numStates()) {
+  reset();
+}
+
+/*
+ * Function: StreamMatcher::reset
+ *
+ *  Forget the input seen so far and start a new match.
+ */
+void StreamMatcher::reset() {
+  isDead = false;
+  bytesConsumed = 0;
+
+  if (lazyDFA != nullptr) {
+    engine = Engine::LazyDFA;
+    state = lazyDFA->startMatch();
+  } else if (dfa != nullptr) {
+    state = dfa->startState;
+  } else {
+    currentSet.clear();
+    AddFrozenState(*nfa, currentSet, nfa->startState, stack);
+  }
+}
+
+/*
+ * Function: StreamMatcher::fallBackToNFA
+ *
+ *  Continue a LazyDFA match on its NFA, starting from the NFA states of the
+ *  current DFA state.
+ */
+void StreamMatcher::fallBackToNFA() {
+  nfa = &lazyDFA->automaton();
+  currentSet.clear();
+  for (uint32_t nfaState : lazyDFA->nfaStatesOf(state)) {
+    currentSet.insert(nfaState);
+  }
+  engine = Engine::NFA;
+}
+
+/*
+ * Function: StreamMatcher::feedNFA
+ *
+ *  Advance the NFA state set over a chunk.
+ *
+ *  @param data Start of the chunk
+ *  @param length Number of bytes in the chunk
+ */
+void StreamMatcher::feedNFA(const char *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    nextSet.clear();
+    StepFrozenStates(*nfa, currentSet, data[i], nextSet, stack);
+    std::swap(currentSet, nextSet);
+    if (currentSet.empty()) {
+      isDead = true;
+      return;
+    }
+  }
+}
+
+/*
+ * Function: StreamMatcher::feed
+ *
+ *  Match the next chunk of input. Once no match is possible any more the
+ *  remaining chunks are only counted.
+ *
+ *  @param data Start of the chunk
+ *  @param length Number of bytes in the chunk
+ */
+void StreamMatcher::feed(const char *data, size_t length) {
+  bytesConsumed += length;
+  if (isDead) {
+    return;
+  }
+
+  if (engine == Engine::NFA) {
+    feedNFA(data, length);
+  }
+
+  else if (engine == Engine::DFA) {
+    for (size_t i = 0; i < length; i++) {
+      state = dfa->next(state, data[i]);
+      if (state == dfa->deadState) {
+        isDead = true;
+        return;
+      }
+    }
+  }
+
+  else {
+    for (size_t i = 0; i < length; i++) {
+      int next = lazyDFA->advance(state, data[i]);
+      if (next == DFA_UNKNOWN) {
+        fallBackToNFA();
+        feedNFA(data + i, length - i);
+        return;
+      }
+      state = next;
+      if (lazyDFA->isDead(state)) {
+        isDead = true;
+        return;
+      }
+    }
+  }
+}
+
+/*
+ * Function: StreamMatcher::accepting
+ *
+ *  Check whether the input seen so far is accepted.
+ *
+ *  @return TRUE if the automaton accepts the bytes fed so far
+ */
+bool StreamMatcher::accepting() const {
+  if (isDead) {
+    return false;
+  }
+  if (engine == Engine::DFA) {
+    return dfa->accepting[state];
+  }
+  if (engine == Engine::LazyDFA) {
+    return lazyDFA->isAccepting(state);
+  }
+  for (uint32_t nfaState : currentSet) {
+    if (nfa->isTerminal[nfaState]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Function: StreamMatcher::finish
+ *
+ *  End the input.
+ *
+ *  @return Number of bytes matched if the whole input is accepted, -1
+ *  otherwise
+ */
+int64_t StreamMatcher::finish() {
+  if (!accepting()) {
+    return -1;
+  }
+  return bytesConsumed;
+}
+
+/*
+ * Function: MatchStream
+ *  Feed a stream to a matcher in chunks of STREAM_CHUNK_SIZE bytes until it
+ *  ends. Works for pipes such as std::cin as well as files.
+ *
+ * @param matcher
+ * @param stream
+ *
+ * @return Number of bytes matched if the whole stream is accepted, -1
+ * otherwise.
+ */
+int64_t MatchStream(StreamMatcher &matcher, std::istream &stream) {
+  std::vector<char> chunk(STREAM_CHUNK_SIZE);
+  matcher.reset();
+  while (stream) {
+    stream.read(chunk.data(), chunk.size());
+    matcher.feed(chunk.data(), stream.gcount());
+  }
+  return matcher.finish();
+}
+
+/*
+ * Function: MatchFile
+ *  Feed a file to a matcher in chunks of STREAM_CHUNK_SIZE bytes.
+ *
+ * @param matcher
+ * @param path
+ *
+ * @return Number of bytes matched if the whole file is accepted, -1 if it is
+ * rejected or cannot be opened.
+ */
+int64_t MatchFile(StreamMatcher &matcher, const std::string &path) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return -1;
+  }
+
+  std::vector<char> chunk(STREAM_CHUNK_SIZE);
+  matcher.reset();
+  size_t length;
+  while ((length = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+    matcher.feed(chunk.data(), length);
+  }
+  fclose(file);
+  return matcher.finish();
+}
@@ -0,0 +1,66 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "dfa.h"
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+
+/* Bytes read at a time by MatchStream and MatchFile */
+#define STREAM_CHUNK_SIZE (64 * 1024)
+
+/*
+ * class: StreamMatcher
+ *
+ * Full-match test over input that arrives in pieces. Only the engine state
+ * (an NFA state set or a DFA state) is kept between chunks, so the memory
+ * used does not depend on the length of the input. An NFA or DFA matcher
+ * refers to the automaton it was built from, which must outlive it. A LazyDFA
+ * matcher keeps its own copy, since a cache flush caused by another user
+ * would invalidate the DFA state held between chunks.
+ *
+ * A LazyDFA that starts thrashing in the middle of a stream hands its current
+ * NFA states over and the rest of the stream is simulated on the NFA, the
+ * same way RunLazyDFA does.
+ *
+ */
+class StreamMatcher {
+public:
+  explicit StreamMatcher(const FrozenNFA &nfa);
+  explicit StreamMatcher(const DFA &dfa);
+  explicit StreamMatcher(const LazyDFA &dfa);
+
+  void feed(const char *data, size_t length);
+  int64_t finish();
+  void reset();
+
+  bool accepting() const;
+  int64_t consumed() const { return bytesConsumed; }
+
+private:
+  enum class Engine { NFA, DFA, LazyDFA } engine;
+  const FrozenNFA *nfa;
+  const DFA *dfa;
+  std::unique_ptr<LazyDFA> lazyDFA;
+
+  // NFA state, also used once a LazyDFA falls back
+  SparseSet currentSet;
+  SparseSet nextSet;
+  std::vector<uint32_t> stack;
+
+  // DFA state
+  int state;
+
+  bool isDead;
+  int64_t bytesConsumed;
+
+  void feedNFA(const char *data, size_t length);
+  void fallBackToNFA();
+};
+
+/* Function Prototypes */
+int64_t MatchStream(StreamMatcher &matcher, std::istream &stream);
+int64_t MatchFile(StreamMatcher &matcher, const std::string &path);
+
+#endif /* STREAM_H */
@@ -0,0 +1,59 @@
+#ifndef TABLEDFA_H
+#define TABLEDFA_H
+
+#include <cstdint>
+#include <string_view>
+
+/*
+ * struct: TableDFA
+ *
+ * Minimized DFA written out by the code generator as a constant. Everything
+ * is a fixed-size array, so a TableDFA can be a constexpr variable that lives
+ * in read-only data and needs no construction when the program starts.
+ *
+ * The state count and the number of byte classes are template parameters, and
+ * State is the smallest unsigned type that holds every state index, so each
+ * table gets a matcher specialized to its size.
+ *
+ * @field byteClasses: Column of every byte.
+ * @field transitions: Row-major table, NumClasses entries per state.
+ * @field accepting: True for accepting states.
+ * @field startState: Index of the start state.
+ * @field deadState: Index of the dead state, or NumStates if there is none.
+ *
+ */
+template <typename State, int NumStates, int NumClasses> struct TableDFA {
+  uint8_t byteClasses[256];
+  State transitions[NumStates * NumClasses];
+  bool accepting[NumStates];
+  State startState;
+  State deadState;
+};
+
+/*
+ * Function: RunTableDFA
+ *  Alternative to RunDFA for tables emitted by the code generator.
+ *
+ * @param dfa
+ * @param input
+ *
+ * @return -1 if terminal not found.
+ */
+template <typename State, int NumStates, int NumClasses>
+constexpr int RunTableDFA(const TableDFA<State, NumStates, NumClasses> &dfa,
+                          std::string_view input) {
+  State state = dfa.startState;
+  for (unsigned char symbol : input) {
+    state = dfa.transitions[state * NumClasses + dfa.byteClasses[symbol]];
+    if (state == dfa.deadState) {
+      return -1;
+    }
+  }
+
+  if (!dfa.accepting[state]) {
+    return -1;
+  }
+  return input.size();
+}
+
+#endif /* TABLEDFA_H */
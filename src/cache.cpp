@@ -0,0 +1,235 @@
+#include "../include/cache.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+/* FNV-1a parameters for the 64-bit hash of the generated sources */
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* A digest is only trusted for files last written this long before it was
+ * taken, since a rewrite within the timestamp granularity goes unnoticed */
+#define DIGEST_SETTLE_TIME std::chrono::seconds(2)
+
+/* Name of the counters file inside the cache directory */
+#define CACHE_STATS_FILE "stats"
+
+/**
+ * HashBytes
+ * @brief Continues an FNV-1a hash over some bytes.
+ *
+ * @param hash The hash so far.
+ * @param bytes The bytes to add.
+ * @return The updated hash.
+ */
+static uint64_t HashBytes(uint64_t hash, const std::string &bytes) {
+  for (unsigned char byte : bytes) {
+    hash = (hash ^ byte) * FNV_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * BinaryCache::BinaryCache
+ * @brief Constructor for the BinaryCache class.
+ *
+ * Creates the cache directory if needed and loads the persisted counters.
+ *
+ * @param cache_directory Directory holding the cached binaries.
+ * @param size_budget Total size the cached binaries may take up, in bytes.
+ */
+BinaryCache::BinaryCache(const std::string &cache_directory,
+                         uintmax_t size_budget)
+    : directory(cache_directory), sizeBudget(size_budget), hits(0),
+      misses(0), evictions(0) {
+  std::error_code error;
+  fs::create_directories(directory, error);
+  loadStats();
+}
+
+/**
+ * BinaryCache::hashBuildInputs
+ * @brief Hashes the inputs of a build of the generated code.
+ *
+ * Every .cpp and .h file and every Makefile (which holds the compiler and its
+ * flags) go into the hash in path order, each path followed by the hash of
+ * its contents. Object files and other outputs are left out.
+ *
+ * @param directories The generated code's directory, and the runtime
+ * library's sources that it links against.
+ * @return The hash as 16 hex digits.
+ */
+std::string
+BinaryCache::hashBuildInputs(const std::vector<std::string> &directories) {
+  std::vector<fs::path> inputs;
+  for (const std::string &directory_name : directories) {
+    for (const fs::directory_entry &entry :
+         fs::directory_iterator(directory_name)) {
+      std::string extension = entry.path().extension().string();
+      if (entry.path().filename() == "Makefile" || extension == ".cpp" ||
+          extension == ".h") {
+        inputs.push_back(entry.path());
+      }
+    }
+  }
+  std::sort(inputs.begin(), inputs.end());
+
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (const fs::path &input : inputs) {
+    hash = HashBytes(hash, input.string());
+    hash = HashBytes(hash, std::string(1, '\0'));
+    hash = HashBytes(hash, std::to_string(hashFile(input)));
+  }
+
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return key.str();
+}
+
+/**
+ * BinaryCache::hashFile
+ * @brief Hashes a file's size and contents.
+ *
+ * Reuses the digest of an earlier call if the file's modification time and
+ * size are unchanged and it had settled when that digest was taken.
+ *
+ * @param path The file.
+ * @return The FNV-1a hash.
+ */
+uint64_t BinaryCache::hashFile(const fs::path &path) {
+  std::error_code error;
+  fs::file_time_type writeTime = fs::last_write_time(path, error);
+  uintmax_t size = fs::file_size(path, error);
+  auto known = digests.find(path.string());
+  if (known != digests.end() && known->second.writeTime == writeTime &&
+      known->second.size == size &&
+      writeTime + DIGEST_SETTLE_TIME < known->second.hashedAt) {
+    return known->second.hash;
+  }
+
+  fs::file_time_type hashedAt = fs::file_time_type::clock::now();
+  std::ifstream file(path, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  uint64_t hash = HashBytes(FNV_OFFSET_BASIS, std::to_string(contents.size()));
+  hash = HashBytes(hash, contents);
+  digests[path.string()] = {writeTime, size, hash, hashedAt};
+  return hash;
+}
+
+/**
+ * BinaryCache::lookup
+ * @brief Looks a binary up and counts the hit or miss.
+ *
+ * A hit refreshes the entry's modification time, which is what eviction
+ * orders entries by.
+ *
+ * @param key Hash of the build inputs.
+ * @return Path of the cached binary, or an empty string on a miss.
+ */
+std::string BinaryCache::lookup(const std::string &key) {
+  fs::path entry = directory / key;
+  std::error_code error;
+  if (!fs::is_regular_file(entry, error)) {
+    misses++;
+    saveStats();
+    return "";
+  }
+
+  fs::last_write_time(entry, fs::file_time_type::clock::now(), error);
+  hits++;
+  saveStats();
+  return entry.string();
+}
+
+/**
+ * BinaryCache::store
+ * @brief Adds a freshly built binary to the cache.
+ *
+ * Failing to copy only costs the next run a rebuild, so errors are ignored.
+ *
+ * @param key Hash of the build inputs.
+ * @param binary_path The binary make produced.
+ */
+void BinaryCache::store(const std::string &key,
+                        const std::string &binary_path) {
+  std::error_code error;
+  fs::copy_file(binary_path, directory / key,
+                fs::copy_options::overwrite_existing, error);
+  if (error) {
+    return;
+  }
+  evict();
+  saveStats();
+}
+
+/**
+ * BinaryCache::evict
+ * @brief Removes least recently used binaries until the cache fits its cap.
+ */
+void BinaryCache::evict() {
+  std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+  uintmax_t totalSize = 0;
+  std::error_code error;
+  for (const fs::directory_entry &entry : fs::directory_iterator(directory)) {
+    if (!entry.is_regular_file() ||
+        entry.path().filename() == CACHE_STATS_FILE) {
+      continue;
+    }
+    entries.push_back({entry.last_write_time(error), entry.path()});
+    totalSize += entry.file_size(error);
+  }
+
+  std::sort(entries.begin(), entries.end());
+  for (size_t i = 0; i < entries.size() && totalSize > sizeBudget; i++) {
+    totalSize -= fs::file_size(entries[i].second, error);
+    fs::remove(entries[i].second, error);
+    evictions++;
+  }
+}
+
+/**
+ * BinaryCache::describe
+ * @brief Summarizes the cache for --cache-stats.
+ *
+ * @return Entry count, size and the persisted counters on one line.
+ */
+std::string BinaryCache::describe() {
+  size_t numEntries = 0;
+  uintmax_t totalSize = 0;
+  std::error_code error;
+  for (const fs::directory_entry &entry : fs::directory_iterator(directory)) {
+    if (entry.is_regular_file() &&
+        entry.path().filename() != CACHE_STATS_FILE) {
+      numEntries++;
+      totalSize += entry.file_size(error);
+    }
+  }
+
+  std::ostringstream summary;
+  summary << numEntries << " entries, " << totalSize << " of " << sizeBudget
+          << " bytes, " << hits << " hits, " << misses << " misses, "
+          << evictions << " evictions";
+  return summary.str();
+}
+
+/**
+ * BinaryCache::loadStats
+ * @brief Reads the counters persisted by earlier runs, if any.
+ */
+void BinaryCache::loadStats() {
+  std::ifstream statsFile(directory / CACHE_STATS_FILE);
+  statsFile >> hits >> misses >> evictions;
+  if (!statsFile) {
+    hits = misses = evictions = 0;
+  }
+}
+
+/**
+ * BinaryCache::saveStats
+ * @brief Persists the counters for later runs.
+ */
+void BinaryCache::saveStats() {
+  std::ofstream statsFile(directory / CACHE_STATS_FILE);
+  statsFile << hits << " " << misses << " " << evictions << std::endl;
+}
@@ -8,11 +8,20 @@
  *
  * @param file_location The base directory where generated files will be
  * written.
- * @param instruction_list A vector of instructions to drive code generation.
+ * @param parsed_program The validated program to generate code for.
+ * @param codegen_options Settings such as the matching engine to target.
+ * @param automaton_cache Automata kept from earlier runs, or nullptr to
+ * build every automaton for this run only.
  */
 CodeGenerator::CodeGenerator(std::string file_location,
-                             const std::vector<Instruction> &instruction_list)
-    : instructionList(instruction_list) {
+                             Program &&parsed_program,
+                             const CodegenOptions &codegen_options,
+                             AutomatonCache *automaton_cache)
+    : program(std::move(parsed_program)), options(codegen_options),
+      compiledMatcherCount(0), runtimeLibrary(true),
+      automata(automaton_cache != nullptr ? automaton_cache : &ownAutomata),
+      outputIsStatic(codegen_options.foldTests &&
+                     !codegen_options.reportStats) {
 
   // Open files, store handle in object
   this->fileLocation = file_location;
@@ -31,6 +40,11 @@ CodeGenerator::CodeGenerator(std::string file_location,
     throw std::ios_base::failure("Failed to open file: " + fileLocation +
                                  "complexCode.cpp");
   }
+  complexHeader.open(file_location + "complexCode.h");
+  if (!complexHeader.is_open()) {
+    throw std::ios_base::failure("Failed to open file: " + fileLocation +
+                                 "complexCode.h");
+  }
 
   // Makefile, easier for compilation vs calls in C++
   makeFile.open(file_location + "Makefile");
@@ -56,6 +70,9 @@ CodeGenerator::~CodeGenerator() {
   if (complexCode.is_open()) {
     complexCode.close();
   }
+  if (complexHeader.is_open()) {
+    complexHeader.close();
+  }
 }
 
 /**
@@ -66,10 +83,27 @@ CodeGenerator::~CodeGenerator() {
  * code.
  */
 void CodeGenerator::generateCode() {
+  collectSearchedVariables();
+  runtimeLibrary = needsRuntimeLibrary();
+
+  // Functions and tables generated alongside main, declared in complexCode.h
+  GEN("#ifndef COMPLEX_CODE_H", complexHeader);
+  GEN("#define COMPLEX_CODE_H", complexHeader);
+  GEN("", complexHeader);
+  GEN("#include <string_view>", complexHeader);
+  if (options.engine == CodegenOptions::Engine::Table) {
+    GEN("#include \"tabledfa.h\"", complexHeader);
+  }
+  GEN("", complexHeader);
+  GEN("#include \"complexCode.h\"", complexCode);
 
-  // Generate main file
+  // Generate main file. The runtime header goes first so that its
+  // precompiled version can be used.
+  if (runtimeLibrary) {
+    GEN("#include \"automata.h\"", mainOutput);
+  }
   GEN("#include <iostream>", mainOutput);
-  GEN("#include \"regex.h\"", mainOutput);
+  GEN("#include \"complexCode.h\"", mainOutput);
   GEN("", mainOutput);
   GEN("int main(){", mainOutput);
 
@@ -77,25 +111,54 @@ void CodeGenerator::generateCode() {
   GEN("\tstd::cout << \"------------------\" << std::endl;", mainOutput);
   GEN("\tstd::cout << \"* AutomataScript *\" << std::endl << std::endl;",
       mainOutput);
+  staticOutput = "------------------\n* AutomataScript *\n\n";
 
   GEN("", mainOutput);
   GEN("\t// Setting up important variables", mainOutput);
-  GEN("\tNode* startNode;", mainOutput);
   GEN("\tint error_status;", mainOutput);
+  if (runtimeLibrary) {
+    GEN("\tstd::string search_input;", mainOutput);
+    GEN("\tMatch match;", mainOutput);
+    GEN("\tstd::vector<Match> matches;", mainOutput);
+    GEN("\tSearchStats search_stats;", mainOutput);
+    GEN("\tstd::vector<std::string> pattern_names;", mainOutput);
+    GEN("\tstd::vector<int> pattern_ids;", mainOutput);
+    GEN("\tint64_t stream_length;", mainOutput);
+  }
 
   GEN("", mainOutput);
   GEN("\t// Generating code", mainOutput);
   // Call function for each type of instruction
-  for (Instruction instruction : instructionList) {
+  for (const Instruction &instruction : program.instructions) {
     switch (instruction.inst_type) {
     case Instruction::Type::Test:
-      generateTestCode((TestData *)instruction.data);
+      if (!options.foldTests ||
+          !generateFoldedTestCode(&std::get<TestData>(instruction.data))) {
+        outputIsStatic = false;
+        generateTestCode(&std::get<TestData>(instruction.data));
+      }
+      break;
+    case Instruction::Type::TestAll:
+      outputIsStatic = false;
+      generateTestAllCode(&std::get<TestAllData>(instruction.data));
+      break;
+    case Instruction::Type::Search:
+      outputIsStatic = false;
+      generateSearchCode(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::FindAll:
+      outputIsStatic = false;
+      generateFindAllCode(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::TestFile:
+      outputIsStatic = false;
+      generateTestFileCode(&std::get<TestData>(instruction.data));
       break;
     case Instruction::Type::Print:
-      generatePrintCode((PrintData *)instruction.data);
+      generatePrintCode(&std::get<PrintData>(instruction.data));
       break;
     case Instruction::Type::Assign:
-      generateAssignCode((AssignData *)instruction.data);
+      generateAssignCode(&std::get<AssignData>(instruction.data));
       break;
     case Instruction::Type::Error:
       std::cout << "ERROR, SHOULD NOT BE HERE!" << std::endl;
@@ -107,8 +170,12 @@ void CodeGenerator::generateCode() {
   GEN("\t// End.", mainOutput);
   GEN("\tstd::cout << \"------------------\" << std::endl;", mainOutput);
   GEN("\treturn 0;", mainOutput);
+  staticOutput += "------------------\n";
   GEN("}", mainOutput);
 
+  GEN("", complexHeader);
+  GEN("#endif /* COMPLEX_CODE_H */", complexHeader);
+
   // Generate Makefile
   generateMakefile();
 
@@ -116,6 +183,41 @@ void CodeGenerator::generateCode() {
   generateImplicitCode();
 }
 
+/**
+ * CodeGenerator::generateFoldedTestCode
+ * @brief Evaluates a TEST while transpiling and generates only its output.
+ *
+ * Variables with the same expression share one automaton, and each
+ * automaton is run once per distinct input.
+ *
+ * @param testData Pointer to TestData containing the NFA name and test value.
+ * @return false if the TEST cannot be folded: the variable's expression is
+ * not supported, or the value has an escape that only the C++ compiler
+ * would interpret.
+ */
+bool CodeGenerator::generateFoldedTestCode(const TestData *testData) {
+  auto automaton = foldedAutomata.find(testData->NFA_name);
+  if (automaton == foldedAutomata.end() ||
+      testData->test_value.find('\\') != std::string::npos) {
+    return false;
+  }
+
+  std::string key = automaton->second + '\0' + testData->test_value;
+  auto result = foldedResults.find(key);
+  if (result == foldedResults.end()) {
+    bool accepted = RunNFA(automata->at(automaton->second), 0,
+                           testData->test_value) != -1;
+    result = foldedResults.emplace(key, accepted).first;
+  }
+
+  std::string output = "- " + testData->NFA_name + " <- ";
+  output += testData->test_value;
+  output += result->second ? ": Accepted by NFA." : ": Rejected by NFA.";
+  GEN("\tstd::cout << \"" + output + "\" << std::endl;", mainOutput);
+  staticOutput += output + "\n";
+  return true;
+}
+
 /**
  * CodeGenerator::generateTestCode
  * @brief Generates code for Test instructions.
@@ -126,20 +228,62 @@ void CodeGenerator::generateCode() {
  * @param testData Pointer to TestData containing the NFA name and test value.
  * @warn WARN: Not implemented
  */
-void CodeGenerator::generateTestCode(TestData *testData) {
+void CodeGenerator::generateTestCode(const TestData *testData) {
   std::string instruction = "";
 
-  // Get the appropriate node value.
-  instruction += "\tstartNode = ";
-  instruction += testData->NFA_name;
-  instruction += ".first;";
-  GEN(instruction, mainOutput);
-
-  // Run the NFA, store the status
-  instruction = "\terror_status = RunNFA(startNode, 0, \"";
-  instruction += testData->test_value;
-  instruction += "\");";
-  GEN(instruction, mainOutput);
+  // Run the matcher for the selected engine, store the status
+  if (options.engine == CodegenOptions::Engine::LazyDFA) {
+    instruction = "\terror_status = RunLazyDFA(";
+    instruction += testData->NFA_name;
+    instruction += "_dfa, 0, \"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  } else if (options.engine == CodegenOptions::Engine::DFA) {
+    instruction = "\terror_status = RunDFA(";
+    instruction += testData->NFA_name;
+    instruction += "_dfa, 0, \"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  } else if (options.engine == CodegenOptions::Engine::Direct &&
+             compiledMatchers.count(testData->NFA_name) != 0) {
+    instruction = "\terror_status = ";
+    instruction += compiledMatchers[testData->NFA_name];
+    instruction += "(\"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  } else if (options.engine == CodegenOptions::Engine::Table &&
+             compiledMatchers.count(testData->NFA_name) != 0) {
+    instruction = "\terror_status = RunTableDFA(";
+    instruction += compiledMatchers[testData->NFA_name];
+    instruction += ", \"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  } else if (options.engine == CodegenOptions::Engine::BitNFA) {
+    // Automata with too many transitions for one word run on the NFA
+    instruction = "\terror_status = ";
+    instruction += testData->NFA_name;
+    instruction += "_bits.usable ? RunBitNFA(";
+    instruction += testData->NFA_name;
+    instruction += "_bits, 0, \"";
+    instruction += testData->test_value;
+    instruction += "\") : RunNFA(";
+    instruction += testData->NFA_name;
+    instruction += "_nfa, 0, \"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  } else {
+    instruction = "\terror_status = RunNFA(";
+    instruction += testData->NFA_name;
+    instruction += "_nfa, 0, \"";
+    instruction += testData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  }
 
   // If statement
   instruction = "\tif(error_status == -1){";
@@ -176,6 +320,259 @@ void CodeGenerator::generateTestCode(TestData *testData) {
   return;
 }
 
+/**
+ * CodeGenerator::generateTestAllCode
+ * @brief Generates code for TestAll instructions.
+ *
+ * Constructs code that matches the test value against every listed NFA in a
+ * single pass with a PatternSet, and prints which of them accepted it. Like
+ * Search, TestAll always runs on the NFAs, whatever engine TEST statements
+ * are compiled against.
+ *
+ * The PatternSet of a member list is declared once and reused by later
+ * TestAlls on the same list; it is only built again after one of its
+ * members is reassigned.
+ *
+ * @param testAllData Pointer to TestAllData containing the NFA names and the
+ * test value.
+ */
+void CodeGenerator::generateTestAllCode(const TestAllData *testAllData) {
+  std::string names = "";
+  std::string name_list = "";
+  std::string pattern_list = "";
+  for (const std::string &nfa_name : testAllData->NFA_names) {
+    if (!names.empty()) {
+      names += ", ";
+      name_list += ", ";
+      pattern_list += ", ";
+    }
+    names += nfa_name;
+    name_list += "\"" + nfa_name + "\"";
+    pattern_list += "&" + nfa_name + "_nfa";
+  }
+
+  std::string instruction = "\tpattern_names = {";
+  instruction += name_list;
+  instruction += "};";
+  GEN(instruction, mainOutput);
+
+  // Each member list gets one PatternSet, built again only after one of its
+  // members is reassigned
+  std::string key = PatternSetKey(testAllData->NFA_names);
+  auto named = patternSetNames.find(key);
+  bool declare = named == patternSetNames.end();
+  if (declare) {
+    std::string set_name = "pattern_set_";
+    set_name += std::to_string(patternSetNames.size());
+    named = patternSetNames.emplace(key, set_name).first;
+  }
+  if (builtPatternSets.insert(key).second) {
+    instruction = declare ? "\tPatternSet " : "\t";
+    instruction += named->second;
+    instruction += declare ? "({" : " = PatternSet({";
+    instruction += pattern_list;
+    instruction += "});";
+    GEN(instruction, mainOutput);
+  }
+
+  instruction = "\tpattern_ids = ";
+  instruction += named->second;
+  instruction += ".match(\"";
+  instruction += testAllData->test_value;
+  instruction += "\");";
+  GEN(instruction, mainOutput);
+
+  // No NFA accepted
+  GEN("\tif(pattern_ids.empty()){", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += names;
+  instruction += " <- ";
+  instruction += testAllData->test_value;
+  instruction += ": Rejected by all.\" << std::endl;";
+  GEN(instruction, mainOutput);
+  GEN("\t}", mainOutput);
+
+  // List the NFAs that accepted
+  GEN("\telse{", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += names;
+  instruction += " <- ";
+  instruction += testAllData->test_value;
+  instruction += ": Accepted by\";";
+  GEN(instruction, mainOutput);
+  GEN("\t\tfor(size_t i = 0; i < pattern_ids.size(); i++){", mainOutput);
+  GEN("\t\t\tstd::cout << (i == 0 ? \" \" : \", \") << "
+      "pattern_names[pattern_ids[i]];",
+      mainOutput);
+  GEN("\t\t}", mainOutput);
+  GEN("\t\tstd::cout << \".\" << std::endl;", mainOutput);
+  GEN("\t}", mainOutput);
+}
+
+/**
+ * CodeGenerator::generateSearchCode
+ * @brief Generates code for Search instructions.
+ *
+ * Constructs code to find the leftmost-longest match of an NFA inside the
+ * test value and prints the matched text and its position. Searching always
+ * uses the NFA, whatever engine TEST statements are compiled against.
+ *
+ * @param searchData Pointer to TestData containing the NFA name and the text
+ * to search.
+ */
+void CodeGenerator::generateSearchCode(const TestData *searchData) {
+  std::string instruction = "";
+
+  instruction = "\tsearch_input = \"";
+  instruction += searchData->test_value;
+  instruction += "\";";
+  GEN(instruction, mainOutput);
+
+  instruction = "\tmatch = SearchNFA(";
+  instruction += searchData->NFA_name;
+  instruction += "_searcher, 0, search_input, &search_stats);";
+  GEN(instruction, mainOutput);
+  generateSearchStatsCode(searchData->NFA_name);
+
+  // Nothing found
+  GEN("\tif(match.start == -1){", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += searchData->NFA_name;
+  instruction += " <- ";
+  instruction += searchData->test_value;
+  instruction += ": No match.\" << std::endl;";
+  GEN(instruction, mainOutput);
+  GEN("\t}", mainOutput);
+
+  // Print the match and where it is
+  GEN("\telse{", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += searchData->NFA_name;
+  instruction += " <- ";
+  instruction += searchData->test_value;
+  instruction += ": Found \" << search_input.substr(match.start, match.end - "
+                 "match.start) << \" at \" << match.start << \"-\" << "
+                 "match.end << \".\" << std::endl;";
+  GEN(instruction, mainOutput);
+  GEN("\t}", mainOutput);
+}
+
+/**
+ * CodeGenerator::generateFindAllCode
+ * @brief Generates code for FindAll instructions.
+ *
+ * Constructs code to collect every non-overlapping match of an NFA inside the
+ * test value and prints how many were found, followed by each match and its
+ * position.
+ *
+ * @param findAllData Pointer to TestData containing the NFA name and the text
+ * to search.
+ */
+void CodeGenerator::generateFindAllCode(const TestData *findAllData) {
+  std::string instruction = "";
+
+  instruction = "\tsearch_input = \"";
+  instruction += findAllData->test_value;
+  instruction += "\";";
+  GEN(instruction, mainOutput);
+
+  instruction = "\tmatches = FindAllNFA(";
+  instruction += findAllData->NFA_name;
+  instruction += "_searcher, search_input, &search_stats);";
+  GEN(instruction, mainOutput);
+  generateSearchStatsCode(findAllData->NFA_name);
+
+  instruction = "\tstd::cout << \"- ";
+  instruction += findAllData->NFA_name;
+  instruction += " <- ";
+  instruction += findAllData->test_value;
+  instruction += ": \" << matches.size() << \" matches:\";";
+  GEN(instruction, mainOutput);
+
+  GEN("\tfor(const Match &found : matches){", mainOutput);
+  GEN("\t\tstd::cout << \" \" << search_input.substr(found.start, found.end - "
+      "found.start) << \"(\" << found.start << \"-\" << found.end << \")\";",
+      mainOutput);
+  GEN("\t}", mainOutput);
+  GEN("\tstd::cout << std::endl;", mainOutput);
+}
+
+/**
+ * CodeGenerator::generateTestFileCode
+ * @brief Generates code for TestFile instructions.
+ *
+ * Constructs code that streams a file, or stdin for "-", through a
+ * StreamMatcher in fixed-size chunks and prints whether its whole content
+ * was accepted. The DFA and lazy DFA engines stream through `<var>_dfa`;
+ * every other engine streams through the NFA.
+ *
+ * @param testFileData Pointer to TestData containing the NFA name and the
+ * path.
+ */
+void CodeGenerator::generateTestFileCode(const TestData *testFileData) {
+  std::string instruction = "";
+  bool dfa = options.engine == CodegenOptions::Engine::DFA ||
+             options.engine == CodegenOptions::Engine::LazyDFA;
+
+  GEN("\t{", mainOutput);
+  instruction = "\t\tStreamMatcher stream_matcher(";
+  instruction += testFileData->NFA_name;
+  instruction += dfa ? "_dfa);" : "_nfa);";
+  GEN(instruction, mainOutput);
+  if (testFileData->test_value == "-") {
+    GEN("\t\tstream_length = MatchStream(stream_matcher, std::cin);",
+        mainOutput);
+  } else {
+    instruction = "\t\tstream_length = MatchFile(stream_matcher, \"";
+    instruction += testFileData->test_value;
+    instruction += "\");";
+    GEN(instruction, mainOutput);
+  }
+  GEN("\t}", mainOutput);
+
+  // Unreadable files are rejected too
+  GEN("\tif(stream_length == -1){", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += testFileData->NFA_name;
+  instruction += " <- ";
+  instruction += testFileData->test_value;
+  instruction += ": Rejected by NFA.\" << std::endl;";
+  GEN(instruction, mainOutput);
+  GEN("\t}", mainOutput);
+
+  GEN("\telse{", mainOutput);
+  instruction = "\t\tstd::cout << \"- ";
+  instruction += testFileData->NFA_name;
+  instruction += " <- ";
+  instruction += testFileData->test_value;
+  instruction += ": Accepted by NFA (\" << stream_length << \" bytes).\" << "
+                 "std::endl;";
+  GEN(instruction, mainOutput);
+  GEN("\t}", mainOutput);
+}
+
+/**
+ * CodeGenerator::generateSearchStatsCode
+ * @brief Generates code printing the prefilter counters of the last search.
+ *
+ * Only emits code when statistics were requested.
+ *
+ * @param nfa_name Name of the NFA that was searched with.
+ */
+void CodeGenerator::generateSearchStatsCode(const std::string &nfa_name) {
+  if (!options.reportStats) {
+    return;
+  }
+
+  std::string instruction = "\tstd::cerr << \"[search] ";
+  instruction += nfa_name;
+  instruction += ": \" << search_stats.bytesSkipped << \" of \" << "
+                 "search_input.size() << \" bytes skipped by the prefilter in "
+                 "\" << search_stats.prefilterScans << \" scans\" << "
+                 "std::endl;";
+  GEN(instruction, mainOutput);
+}
+
 /**
  * CodeGenerator::generatePrintCode
  * @brief Generates code for Print instructions.
@@ -184,7 +581,7 @@ void CodeGenerator::generateTestCode(TestData *testData) {
  *
  * @param printData Pointer to PrintData containing the string to print.
  */
-void CodeGenerator::generatePrintCode(PrintData *printData) {
+void CodeGenerator::generatePrintCode(const PrintData *printData) {
   std::string instruction = "";
   instruction += "\tstd::cout << \"";
   instruction += printData->output_string;
@@ -192,6 +589,11 @@ void CodeGenerator::generatePrintCode(PrintData *printData) {
 
   GEN(instruction, mainOutput);
 
+  if (printData->output_string.find('\\') != std::string::npos) {
+    outputIsStatic = false;
+  }
+  staticOutput += printData->output_string + "\n";
+
   return;
 }
 
@@ -207,28 +609,406 @@ void CodeGenerator::generatePrintCode(PrintData *printData) {
  * @todo TODO: Check if I should display anything to the user that the variable
  * was created
  */
-void CodeGenerator::generateAssignCode(AssignData *assignData) {
+void CodeGenerator::generateAssignCode(const AssignData *assignData) {
   std::string instruction = "\t";
 
-  // Grab the desired variable name
+  // Grab the desired variable name. Variables are declared on their first
+  // assignment; reassigning releases the old automaton through its handle.
   std::string lhs = assignData->lhs;
-  instruction += "std::pair<Node *, Node*> ";
+
+  // TESTALL sets built with the old automaton have to be built again
+  for (auto set = builtPatternSets.begin(); set != builtPatternSets.end();) {
+    if (PatternSetHasMember(*set, lhs)) {
+      set = builtPatternSets.erase(set);
+    } else {
+      set++;
+    }
+  }
+
+  // Folded TESTs do not need the automaton at runtime
+  if (options.foldTests) {
+    foldAssignment(lhs, assignData->rhs);
+    if (foldedAutomata.count(lhs) != 0 &&
+        searchedVariables.find(lhs) == searchedVariables.end()) {
+      return;
+    }
+  }
+
+  // The direct and table engines compile the variable right here. Its NFA is
+  // only built at runtime if a SEARCH, FINDALL or TESTALL uses it.
+  if ((options.engine == CodegenOptions::Engine::Direct ||
+       options.engine == CodegenOptions::Engine::Table) &&
+      generateCompiledMatcher(lhs, assignData->rhs) &&
+      searchedVariables.find(lhs) == searchedVariables.end()) {
+    return;
+  }
+
+  bool declare = declaredVariables.insert(lhs).second;
+  if (declare) {
+    instruction += "NfaHandle ";
+  }
   instruction += lhs;
   instruction += " = ";
 
-  Exp *rhs = assignData->rhs;
-  std::string rhs_code = generateRhsCode(rhs); // Generate exp
+  std::string rhs_code = generateRhsCode(assignData->rhs); // Generate exp
 
   instruction += rhs_code;
 
   GEN(instruction, mainOutput);
 
+  // Build the engine specific matcher next to the NFA
+  generateMatcherCode(lhs, declare);
+
   // TODO: Check if I should display anything to the user that the variable was
   // created
 
   return;
 }
 
+/**
+ * CodeGenerator::foldAssignment
+ * @brief Builds the automaton of an assignment for folding TESTs.
+ *
+ * @param lhs Name of the variable being assigned.
+ * @param rhs The expression assigned to it. If it is not supported, TESTs on
+ * the variable are no longer folded.
+ */
+void CodeGenerator::foldAssignment(const std::string &lhs, NodeId rhs) {
+  if (CompileExp(program, rhs, *automata) == nullptr) {
+    foldedAutomata.erase(lhs);
+    return;
+  }
+  foldedAutomata[lhs] = ExpKey(program, rhs);
+}
+
+/**
+ * CodeGenerator::generateMatcherCode
+ * @brief Generates the matcher a variable is tested with.
+ *
+ * Every engine starts from `<lhs>_nfa`, the frozen (flat) copy of the
+ * variable's graph. The NFA engine simulates it directly, the lazy DFA gets a
+ * `<lhs>_dfa` object holding its state cache, the DFA engine compiles a
+ * minimized `<lhs>_dfa` table up front, and the bit-parallel engine builds
+ * the `<lhs>_bits` position automaton. Variables that SEARCH or FINDALL run
+ * on also get a `<lhs>_searcher`, so its prefilter is computed once per
+ * assignment rather than once per statement.
+ *
+ * @param lhs Name of the variable that was just assigned.
+ * @param declare True on the variable's first assignment, when the matcher
+ * variables still have to be declared.
+ */
+void CodeGenerator::generateMatcherCode(const std::string &lhs, bool declare) {
+  std::string instruction;
+
+  instruction = declare ? "\tFrozenNFA " : "\t";
+  instruction += lhs;
+  instruction += "_nfa = freeze(";
+  instruction += lhs;
+  instruction += ".start);";
+  GEN(instruction, mainOutput);
+
+  if (searcherVariables.count(lhs) != 0) {
+    instruction = declare ? "\tSearcher " : "\t";
+    instruction += lhs;
+    instruction += "_searcher = Searcher(";
+    instruction += lhs;
+    instruction += "_nfa);";
+    GEN(instruction, mainOutput);
+  }
+
+  if (options.engine == CodegenOptions::Engine::LazyDFA) {
+    instruction = declare ? "\tLazyDFA " : "\t";
+    instruction += lhs;
+    instruction += "_dfa = LazyDFA(";
+    instruction += lhs;
+    instruction += "_nfa";
+    if (options.dfaCacheBudget != 0) {
+      instruction += ", ";
+      instruction += std::to_string(options.dfaCacheBudget);
+    }
+    instruction += ");";
+    GEN(instruction, mainOutput);
+  }
+
+  else if (options.engine == CodegenOptions::Engine::DFA) {
+    if (declare) {
+      instruction = "\tDFAStats ";
+      instruction += lhs;
+      instruction += "_stats;";
+      GEN(instruction, mainOutput);
+    }
+
+    instruction = declare ? "\tDFA " : "\t";
+    instruction += lhs;
+    instruction += "_dfa = CompileDFA(";
+    instruction += lhs;
+    instruction += "_nfa, &";
+    instruction += lhs;
+    instruction += "_stats);";
+    GEN(instruction, mainOutput);
+
+    if (options.reportStats) {
+      instruction = "\tstd::cerr << \"[dfa] ";
+      instruction += lhs;
+      instruction += ": \" << ";
+      instruction += lhs;
+      instruction += "_stats.nfaStates << \" NFA states, \" << ";
+      instruction += lhs;
+      instruction += "_stats.dfaStates << \" DFA states, \" << ";
+      instruction += lhs;
+      instruction += "_stats.minimizedStates << \" after minimization, \" << ";
+      instruction += lhs;
+      instruction += "_stats.byteClasses << \" byte classes\" << std::endl;";
+      GEN(instruction, mainOutput);
+    }
+  }
+
+  else if (options.engine == CodegenOptions::Engine::BitNFA) {
+    instruction = declare ? "\tBitNFA " : "\t";
+    instruction += lhs;
+    instruction += "_bits = CompileBitNFA(";
+    instruction += lhs;
+    instruction += "_nfa);";
+    GEN(instruction, mainOutput);
+
+    if (options.reportStats) {
+      instruction = "\tstd::cerr << \"[bitnfa] ";
+      instruction += lhs;
+      instruction += ": \" << (";
+      instruction += lhs;
+      instruction += "_bits.usable ? std::to_string(";
+      instruction += lhs;
+      instruction += "_bits.numPositions) + \" positions\" : \"too many "
+                     "positions, matching on the NFA\") << std::endl;";
+      GEN(instruction, mainOutput);
+    }
+  }
+}
+
+/**
+ * CodeGenerator::collectSearchedVariables
+ * @brief Records every variable a SEARCH, FINDALL, TESTALL or TESTFILE
+ * refers to.
+ *
+ * Those statements run on the variable's NFA, so the direct engine still
+ * has to build it at runtime for them. The same goes for TESTs that
+ * cannot be folded.
+ */
+void CodeGenerator::collectSearchedVariables() {
+  for (const Instruction &instruction : program.instructions) {
+    if (instruction.inst_type == Instruction::Type::Search ||
+        instruction.inst_type == Instruction::Type::FindAll) {
+      const std::string &nfa_name =
+          std::get<TestData>(instruction.data).NFA_name;
+      searchedVariables.insert(nfa_name);
+      searcherVariables.insert(nfa_name);
+    } else if (instruction.inst_type == Instruction::Type::TestFile) {
+      searchedVariables.insert(std::get<TestData>(instruction.data).NFA_name);
+    } else if (instruction.inst_type == Instruction::Type::TestAll) {
+      for (const std::string &nfa_name :
+           std::get<TestAllData>(instruction.data).NFA_names) {
+        searchedVariables.insert(nfa_name);
+      }
+    } else if (instruction.inst_type == Instruction::Type::Test &&
+               options.foldTests) {
+      const TestData *testData = &std::get<TestData>(instruction.data);
+      if (testData->test_value.find('\\') != std::string::npos) {
+        searchedVariables.insert(testData->NFA_name);
+      }
+    }
+  }
+}
+
+/**
+ * CodeGenerator::needsRuntimeLibrary
+ * @brief Checks whether the generated program uses anything from lib/.
+ *
+ * Programs can do without it when every TEST is folded or runs on a table
+ * or direct-coded matcher. That needs every assignment to be evaluated while
+ * transpiling and no statement that runs on an NFA.
+ *
+ * @return true if the runtime library has to be included.
+ */
+bool CodeGenerator::needsRuntimeLibrary() {
+  bool compiled = options.engine == CodegenOptions::Engine::Direct ||
+                  options.engine == CodegenOptions::Engine::Table;
+  if ((!compiled && !options.foldTests) || !searchedVariables.empty()) {
+    return true;
+  }
+  for (const Instruction &instruction : program.instructions) {
+    if (instruction.inst_type == Instruction::Type::Assign &&
+        BuildExpNFA(program, std::get<AssignData>(instruction.data).rhs)
+                .start == nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * CodeGenerator::generateCompiledMatcher
+ * @brief Compiles a variable to a minimized DFA and writes it out.
+ *
+ * The direct engine turns the DFA into a function in complexCode.cpp, the
+ * table engine into a constexpr table in complexCode.h. TEST statements on
+ * the variable use it until the variable is reassigned.
+ *
+ * @param lhs Name of the variable being assigned.
+ * @param rhs The expression assigned to it.
+ * @return true if the matcher was generated; false if the expression is not
+ * supported, in which case TEST falls back to the NFA.
+ */
+bool CodeGenerator::generateCompiledMatcher(const std::string &lhs,
+                                            NodeId rhs) {
+  const FrozenNFA *nfa = CompileExp(program, rhs, *automata);
+  if (nfa == nullptr) {
+    compiledMatchers.erase(lhs);
+    return false;
+  }
+
+  DFAStats stats;
+  DFA dfa = CompileDFA(*nfa, &stats);
+  bool direct = options.engine == CodegenOptions::Engine::Direct;
+  std::string matcher_name = direct ? "DirectMatch_" : "TableMatch_";
+  matcher_name += lhs + "_" + std::to_string(compiledMatcherCount++);
+  if (direct) {
+    writeDirectMatcher(dfa, matcher_name);
+  } else {
+    writeTableMatcher(dfa, matcher_name);
+  }
+  compiledMatchers[lhs] = matcher_name;
+
+  if (options.reportStats) {
+    std::string instruction = "\tstd::cerr << \"";
+    instruction += direct ? "[direct] " : "[table] ";
+    instruction += lhs;
+    instruction += ": ";
+    instruction += std::to_string(stats.minimizedStates);
+    instruction += direct ? " DFA states compiled to code"
+                          : " DFA states compiled to a table";
+    instruction += "\" << std::endl;";
+    GEN(instruction, mainOutput);
+  }
+  return true;
+}
+
+/**
+ * CodeGenerator::writeDirectMatcher
+ * @brief Writes a DFA out as a function with one label per state.
+ *
+ * Each state checks for the end of the input and then switches on the next
+ * byte, jumping straight to the label of the next state. Bytes that lead to
+ * the same state are grouped into case ranges, which g++ accepts as an
+ * extension. Transitions into the dead state fall to the default case and
+ * reject.
+ *
+ * @param dfa The minimized DFA.
+ * @param function_name Name of the generated function.
+ */
+void CodeGenerator::writeDirectMatcher(const DFA &dfa,
+                                       const std::string &function_name) {
+  GEN("int " + function_name + "(std::string_view input);", complexHeader);
+
+  GEN("", complexCode);
+  GEN("int " + function_name + "(std::string_view input) {", complexCode);
+  GEN("\tconst unsigned char *cursor = (const unsigned char *)input.data();",
+      complexCode);
+  GEN("\tconst unsigned char *limit = cursor + input.size();", complexCode);
+  if (dfa.startState == dfa.deadState) {
+    GEN("\treturn -1;", complexCode);
+    GEN("}", complexCode);
+    return;
+  }
+  GEN("\tgoto state_" + std::to_string(dfa.startState) + ";", complexCode);
+
+  for (int state = 0; state < dfa.numStates(); state++) {
+    if (state == dfa.deadState) {
+      continue;
+    }
+    GEN("state_" + std::to_string(state) + ":", complexCode);
+    GEN(dfa.accepting[state] ? "\tif (cursor == limit) return input.size();"
+                             : "\tif (cursor == limit) return -1;",
+        complexCode);
+    GEN("\tswitch (*cursor++) {", complexCode);
+
+    // One group of case labels per target state, one label per run of
+    // consecutive bytes, so a class such as (a-z) is a single GNU case range
+    std::vector<std::vector<std::pair<int, int>>> runsTo(dfa.numStates());
+    for (int byte = 0; byte < 256; byte++) {
+      std::vector<std::pair<int, int>> &runs = runsTo[dfa.next(state, byte)];
+      if (!runs.empty() && runs.back().second == byte - 1) {
+        runs.back().second = byte;
+      } else {
+        runs.push_back({byte, byte});
+      }
+    }
+    for (int target = 0; target < dfa.numStates(); target++) {
+      if (target == dfa.deadState || runsTo[target].empty()) {
+        continue;
+      }
+      for (const std::pair<int, int> &run : runsTo[target]) {
+        std::string label = "\tcase " + std::to_string(run.first);
+        if (run.second != run.first) {
+          label += " ... " + std::to_string(run.second);
+        }
+        GEN(label + ":", complexCode);
+      }
+      GEN("\t\tgoto state_" + std::to_string(target) + ";", complexCode);
+    }
+    GEN("\tdefault:", complexCode);
+    GEN("\t\treturn -1;", complexCode);
+    GEN("\t}", complexCode);
+  }
+  GEN("}", complexCode);
+}
+
+/**
+ * CodeGenerator::writeTableMatcher
+ * @brief Writes a DFA out as a constexpr TableDFA.
+ *
+ * The state index type is the smallest that fits, so small automata get
+ * byte-sized tables.
+ *
+ * @param dfa The minimized DFA.
+ * @param table_name Name of the generated variable.
+ */
+void CodeGenerator::writeTableMatcher(const DFA &dfa,
+                                      const std::string &table_name) {
+  int numStates = dfa.numStates();
+  std::string state_type = numStates < 256     ? "uint8_t"
+                           : numStates < 65536 ? "uint16_t"
+                                               : "uint32_t";
+  std::string line = "inline constexpr TableDFA<" + state_type + ", ";
+  line += std::to_string(numStates) + ", ";
+  line += std::to_string(dfa.numClasses()) + "> " + table_name + " = {";
+  GEN("", complexHeader);
+  GEN(line, complexHeader);
+
+  // Sixteen entries to a line
+  auto writeArray = [this](const std::vector<int> &values) {
+    GEN("\t{", complexHeader);
+    for (size_t i = 0; i < values.size(); i += 16) {
+      std::string row = "\t\t";
+      for (size_t j = i; j < values.size() && j < i + 16; j++) {
+        row += std::to_string(values[j]) + ",";
+        if (j + 1 < values.size() && j + 1 < i + 16) {
+          row += " ";
+        }
+      }
+      GEN(row, complexHeader);
+    }
+    GEN("\t},", complexHeader);
+  };
+  writeArray(std::vector<int>(dfa.byteClasses.map, dfa.byteClasses.map + 256));
+  writeArray(dfa.transitions);
+  writeArray(std::vector<int>(dfa.accepting.begin(), dfa.accepting.end()));
+
+  int deadState = dfa.deadState == -1 ? numStates : dfa.deadState;
+  line = "\t" + std::to_string(dfa.startState) + ", ";
+  line += std::to_string(deadState) + "};";
+  GEN(line, complexHeader);
+}
+
 /**
  * CodeGenerator::generateMakefile
  * @brief Generates the Makefile used to compile the generated code.
@@ -240,7 +1020,16 @@ void CodeGenerator::generateMakefile() {
 
   GEN("# Compiler + Flags", makeFile);
   GEN("CXX = g++", makeFile);
-  GEN("CXXFLAGS = -Iinclude -std=c++17 -w", makeFile);
+  GEN("CXXFLAGS = -I../runtime -I../../lib -std=c++17 -w", makeFile);
+  GEN("", makeFile)
+
+  GEN("# Runtime library and precompiled header, built by make runtime",
+      makeFile);
+  GEN("LDLIBS = ../runtime/libautomata.a -pthread", makeFile);
+  GEN("", makeFile)
+
+  GEN("# Direct-coded matchers only pay off when optimized", makeFile);
+  GEN("complexCode.o: CXXFLAGS += -O2", makeFile);
   GEN("", makeFile)
 
   GEN("SRC = $(wildcard *.cpp)", makeFile);
@@ -254,7 +1043,7 @@ void CodeGenerator::generateMakefile() {
   GEN("", makeFile)
 
   GEN("$(TARGET): $(OBJ)", makeFile);
-  GEN("\t@$(CXX) $(OBJ) -o $(TARGET)", makeFile);
+  GEN("\t@$(CXX) $(OBJ) $(LDLIBS) -o $(TARGET)", makeFile);
   GEN("", makeFile)
 
   GEN("%.o: %.cpp", makeFile);
@@ -267,100 +1056,39 @@ void CodeGenerator::generateMakefile() {
 
 /**
  * CodeGenerator::generateImplicitCode
- * @brief Generates the implicit NFA code by copying existing source files.
+ * @brief Cleans up copies of the runtime library in the output directory.
  *
- * Reads library files (regex.cpp, regex.h, nfa.cpp, nfa.h) and writes them to
- * the output directory.
+ * Generated programs link against the prebuilt libautomata.a and find the
+ * headers in lib/, so nothing is copied. Copies left behind by older
+ * versions of the transpiler are removed, as the Makefile would build them.
  */
 void CodeGenerator::generateImplicitCode() {
-  // Implicit code.
-
-  // Generating regex.cpp
-  std::ofstream regexCpp;
-  regexCpp.open(fileLocation + "regex.cpp");
-  if (!regexCpp.is_open()) {
-    throw std::ios_base::failure("Failed to open file: " + fileLocation +
-                                 "regex.cpp");
-  }
-  std::ifstream cSourceFile("lib/regex.cpp");
-  if (!cSourceFile.is_open()) {
-    std::cerr << "Error opg file!" << std::endl;
-    return; // Exit on failure
-  }
-  std::string line;
-  // Replace include path (firstline)
-  while (std::getline(cSourceFile, line)) { // Read line by line
-    GEN(line, regexCpp);                    // Use macro to write to output file
-  }
-  cSourceFile.close();
-
-  // Generating regex.h
-  std::ofstream regexH;
-  regexH.open(fileLocation + "regex.h");
-  if (!regexH.is_open()) {
-    throw std::ios_base::failure("Failed to open file: " + fileLocation +
-                                 "regex.h");
-  }
-  // h source file
-  std::ifstream hSourceFile("lib/regex.h");
-  if (!hSourceFile.is_open()) {
-    std::cerr << "Error opg file!" << std::endl;
-    return; // Exit on failure
-  }
-  while (std::getline(hSourceFile, line)) { // Read line by line
-    GEN(line, regexH);                      // Use macro to write to output file
-  }
-  hSourceFile.close();
+  const std::vector<std::string> libraryFiles = {
+      "regex.cpp",      "regex.h",      "nfa.cpp",      "nfa.h",
+      "arena.cpp",      "arena.h",      "frozen.cpp",   "frozen.h",
+      "dfa.cpp",        "dfa.h",        "search.cpp",   "search.h",
+      "prefilter.cpp",  "prefilter.h",  "stream.cpp",   "stream.h",
+      "patternset.cpp", "patternset.h", "bitnfa.cpp",   "bitnfa.h",
+      "tabledfa.h"};
 
-  // Generating nfa.cpp
-  std::ofstream nfaCpp;
-  nfaCpp.open(fileLocation + "nfa.cpp");
-  if (!nfaCpp.is_open()) {
-    throw std::ios_base::failure("Failed to open file: " + fileLocation +
-                                 "nfa.cpp");
-  }
-  std::ifstream nfaCSourceFile("lib/nfa.cpp");
-  if (!nfaCSourceFile.is_open()) {
-    std::cerr << "Error opg file!" << std::endl;
-    return; // Exit on failure
+  for (const std::string &file_name : libraryFiles) {
+    std::remove((fileLocation + file_name).c_str());
   }
-  while (std::getline(nfaCSourceFile, line)) { // Read line by line
-    GEN(line, nfaCpp); // Use macro to write to output file
-  }
-  nfaCSourceFile.close();
-
-  // Generating nfa.h
-  std::ofstream nfaH;
-  nfaH.open(fileLocation + "nfa.h");
-  if (!nfaH.is_open()) {
-    throw std::ios_base::failure("Failed to open file: " + fileLocation +
-                                 "nfa.h");
-  }
-  // h source file
-  std::ifstream nfaHSourceFile("lib/nfa.h");
-  if (!nfaHSourceFile.is_open()) {
-    std::cerr << "Error opg file!" << std::endl;
-    return; // Exit on failure
-  }
-  while (std::getline(nfaHSourceFile, line)) { // Read line by line
-    GEN(line, nfaH); // Use macro to write to output file
-  }
-  nfaHSourceFile.close();
 }
 
 /**
  * CodeGenerator::generateRhsCode
  * @brief Generates code for the right-hand side (RHS) expression.
  *
- * @param rhs Pointer to the expression object.
+ * @param rhs Index of the expression in the program.
  * @return A string containing the generated code for the RHS.
  * @warn WARN: Incomplete
  * @todo TODO: CodeGen for (binop exp_p2)*
  */
-std::string CodeGenerator::generateRhsCode(Exp *rhs) {
+std::string CodeGenerator::generateRhsCode(NodeId rhs) {
   std::string rhs_out = "";
 
-  Exp_p2 *exp_p2 = rhs->exp_p2;
+  const Exp_p2 *exp_p2 = &program.exp_p2s[program.exps[rhs].exp_p2];
   std::string exp_p2_code = generateExpP2Code(exp_p2);
   rhs_out += exp_p2_code;
 
@@ -380,12 +1108,12 @@ std::string CodeGenerator::generateRhsCode(Exp *rhs) {
  * @return A string containing the generated code for the Exp_p2 expression.
  * @warn WARN: Incomplete
  */
-std::string CodeGenerator::generateExpP2Code(Exp_p2 *exp_p2) {
+std::string CodeGenerator::generateExpP2Code(const Exp_p2 *exp_p2) {
   std::string instruction = "";
 
   // If there is no unop, this is simply the p1 expression
   if (exp_p2->unop_type == Exp_p2::Type::None) {
-    Exp_p1 *exp_p1 = exp_p2->exp_p1;
+    const Exp_p1 *exp_p1 = &program.exp_p1s[exp_p2->exp_p1];
     instruction += generateExpP1Code(exp_p1);
     instruction += ",\"";
     instruction += "tmp";
@@ -408,7 +1136,7 @@ std::string CodeGenerator::generateExpP2Code(Exp_p2 *exp_p2) {
       return "ERROR";
     }
 
-    Exp_p1 *exp_p1 = exp_p2->exp_p1;
+    const Exp_p1 *exp_p1 = &program.exp_p1s[exp_p2->exp_p1];
     instruction += generateExpP1Code(exp_p1);
     instruction += ",\"";
     instruction += "tmp";
@@ -424,15 +1152,15 @@ std::string CodeGenerator::generateExpP2Code(Exp_p2 *exp_p2) {
  * CodeGenerator::generateExpP1Code
  * @brief Generates code for an Exp_p1 expression.
  *
- * Handles literal expressions; additional cases for Exp and Lval are to be
- * added.
+ * Handles literal and range expressions; additional cases for Exp and Lval
+ * are to be added.
  *
  * @param exp_p1 Pointer to the Exp_p1 object.
  * @return A string containing the generated code for the Exp_p1 expression.
  * @warn WARN: Incomplete
  * @todo TODO: Cases for Exp, Lval
  */
-std::string CodeGenerator::generateExpP1Code(Exp_p1 *exp_p1) {
+std::string CodeGenerator::generateExpP1Code(const Exp_p1 *exp_p1) {
   std::string output = "";
 
   if (exp_p1->exp_p1_type == Exp_p1::Type::Exp_ac) {
@@ -442,6 +1170,16 @@ std::string CodeGenerator::generateExpP1Code(Exp_p1 *exp_p1) {
     return output;
   }
 
+  // A range becomes a single character class edge
+  if (exp_p1->exp_p1_type == Exp_p1::Type::Range) {
+    output += "RangeNFA('";
+    output += exp_p1->range_low;
+    output += "', '";
+    output += exp_p1->range_high;
+    output += "'";
+    return output;
+  }
+
   // TODO: Cases for Exp, Lval
 
   return "";
@@ -0,0 +1,187 @@
+#include "../include/driver.h"
+#include "../include/logger.h"
+#include "../include/parse.h"
+#include "../include/source.h"
+#include "../include/tokenize.h"
+#include "../include/validate.h"
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+/* Validated programs the server keeps before starting over */
+#define DRIVER_MAX_PROGRAMS 1024
+
+/**
+ * Driver::Driver
+ * @brief Constructor for the Driver class.
+ *
+ * @param codegen_options Settings of the generated code.
+ * @param driver_options Settings of the transpiler itself.
+ */
+Driver::Driver(const CodegenOptions &codegen_options,
+               const DriverOptions &driver_options)
+    : options(codegen_options), driver(driver_options) {}
+
+/**
+ * Driver::runFile
+ * @brief Runs the script in a file.
+ *
+ * @param source_file Path of the script.
+ * @return 0 on success; 1 if the script cannot be read or is invalid; 2 if
+ * it cannot be run.
+ */
+int Driver::runFile(const std::string &source_file) {
+  // Map the script; tokens and parser work on its pages directly
+  SourceFile source(source_file);
+  if (!source.isOpen()) {
+    std::cerr << "Failed to open the file.\n";
+    return 1;
+  }
+  return runSource(source.text());
+}
+
+/**
+ * Driver::runSource
+ * @brief Runs a script.
+ *
+ * When serving, the validated program is kept, and a source seen before
+ * skips straight to running it.
+ *
+ * @param input The text of the script.
+ * @return 0 on success; 1 if the script is invalid; 2 if it cannot be run.
+ */
+int Driver::runSource(std::string_view input) {
+  std::string key = "";
+  if (driver.serve) {
+    key = std::to_string(std::hash<std::string_view>{}(input)) + ":" +
+          std::to_string(input.size());
+    auto known = programs.find(key);
+    if (known != programs.end()) {
+      return buildAndRun(Program(known->second));
+    }
+  }
+
+  Program program;
+  if (!parseSource(input, program)) {
+    return 1;
+  }
+
+  if (driver.serve) {
+    if (programs.size() >= DRIVER_MAX_PROGRAMS) {
+      programs.clear();
+    }
+    programs.emplace(key, program);
+  }
+  return buildAndRun(std::move(program));
+}
+
+/**
+ * Driver::parseSource
+ * @brief Tokenizes, parses and validates a script, printing any error.
+ *
+ * @param input The text of the script.
+ * @param program Receives the validated program.
+ * @return true if the script is valid; otherwise, false.
+ */
+bool Driver::parseSource(std::string_view input, Program &program) {
+  // Tokenize everything. The tokens are spans of input, which outlives them
+  std::vector<Token> tokens = mainTokenizer(input);
+  if (!tokens.empty() && tokens[0].kind == TokenKind::Error) {
+    std::cout << "ERROR: Tokenizing at offset " << tokens[0].offset
+              << std::endl;
+    return false;
+  }
+  logger.log_tokens(tokens, input);
+
+  // Take the tokens, turn into AST.
+  Parser parser(tokens, input);
+  program = parser.mainParser();
+  if (!program.instructions.empty() &&
+      program.instructions[0].inst_type == Instruction::Type::Error) {
+    std::cout << "Parsing error at index "
+              << std::get<ErrorData>(program.instructions[0].data).error_index
+              << std::endl;
+    return false;
+  }
+
+  // Validation phase
+  // If parsing is successful, there may be places that are invalid, e.g.
+  // attempting to access an unused variable, etc.
+  Validator validator(program);
+  int validate_status = validator.validate();
+  if (validate_status == -1) {
+    std::cout << "Validation error" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Driver::buildAndRun
+ * @brief Interprets a validated program, or generates, compiles and runs
+ * its C++.
+ *
+ * @param program The validated program.
+ * @return 0 on success; 2 if it cannot be run.
+ */
+int Driver::buildAndRun(Program &&program) {
+  // Interpreted scripts skip code generation entirely
+  if (driver.interpret) {
+    Interpreter interpreter(std::move(program), &automata);
+    return interpreter.run() == 0 ? 0 : 2;
+  }
+
+  // Generate the C++ code, store it in file location
+  std::string cppDirectory = "bin/tmp/";
+  bool staticOutput = false;
+  {
+    CodeGenerator codegen(cppDirectory, std::move(program), options,
+                          &automata);
+    codegen.generateCode();
+
+    // Every statement was evaluated already, so there is nothing to compile
+    staticOutput = codegen.hasStaticOutput();
+    if (staticOutput) {
+      std::cout << codegen.getStaticOutput();
+    }
+  }
+  if (staticOutput) {
+    return 0;
+  }
+
+  // Reuse the binary of an earlier run whose generated code was the same
+  std::string binaryName = "./bin/compiled_output";
+  if (binaryCache == nullptr) {
+    binaryCache =
+        std::make_unique<BinaryCache>("bin/cache/", driver.cacheBudget);
+  }
+  std::string cacheKey = "";
+  std::string cachedBinary = "";
+  if (driver.cacheBudget > 0) {
+    cacheKey = binaryCache->hashBuildInputs({cppDirectory, "lib/"});
+    cachedBinary = binaryCache->lookup(cacheKey);
+  }
+
+  // Compile & run generated code
+  if (!cachedBinary.empty()) {
+    binaryName = cachedBinary;
+  } else {
+    std::string compileCommand = "make -C bin/tmp/";
+    if (std::system(compileCommand.c_str()) != 0) {
+      std::cerr << "Compilation failed!\n";
+      return 2;
+    }
+    if (driver.cacheBudget > 0) {
+      binaryCache->store(cacheKey, binaryName);
+    }
+  }
+  if (driver.cacheStats) {
+    std::cerr << "[cache] " << (cachedBinary.empty() ? "miss " : "hit ")
+              << cacheKey << ": " << binaryCache->describe() << std::endl;
+  }
+  std::cout.flush();
+  std::system(binaryName.c_str());
+
+  return 0;
+}
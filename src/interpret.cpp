@@ -0,0 +1,358 @@
+#include "../include/interpret.h"
+#include "../lib/stream.h"
+
+/**
+ * BuildExpNFA
+ * @brief Builds the NFA of an expression with the runtime library.
+ *
+ * Makes the builder calls that CodeGenerator::generateRhsCode writes out, so
+ * the result is the automaton the generated program would build.
+ *
+ * @param program The program the expression belongs to.
+ * @param exp Index of the Exp in the program.
+ * @return The NFA, or a handle with a null start for expressions that
+ * generateRhsCode cannot generate either.
+ */
+NfaHandle BuildExpNFA(const Program &program, NodeId exp) {
+  NfaHandle nfa = {nullptr, nullptr, nullptr};
+  const Exp_p2 *exp_p2 = &program.exp_p2s[program.exps[exp].exp_p2];
+  const Exp_p1 *exp_p1 = &program.exp_p1s[exp_p2->exp_p1];
+
+  if (exp_p1->exp_p1_type == Exp_p1::Type::Exp_ac) {
+    nfa = LiteralNFA(exp_p1->identifier, "tmp");
+  } else if (exp_p1->exp_p1_type == Exp_p1::Type::Range) {
+    nfa = RangeNFA(exp_p1->range_low, exp_p1->range_high, "tmp");
+  } else {
+    return nfa;
+  }
+
+  switch (exp_p2->unop_type) {
+  case Exp_p2::Type::KleeneStar:
+    return KleeneStarNFA(nfa);
+  case Exp_p2::Type::PosClos:
+    return PlusNFA(nfa);
+  case Exp_p2::Type::Opt:
+    return OptionalNFA(nfa);
+  default:
+    return nfa;
+  }
+}
+
+/**
+ * ExpKey
+ * @brief Describes an expression as text, for caching its automaton.
+ *
+ * Literals are written as a quote and the literal, ranges as (a-z), followed
+ * by the unary operator if there is one.
+ *
+ * @param program The program the expression belongs to.
+ * @param exp Index of the Exp in the program.
+ * @return The key, or an empty string if BuildExpNFA cannot build the
+ * expression.
+ */
+std::string ExpKey(const Program &program, NodeId exp) {
+  const Exp_p2 *exp_p2 = &program.exp_p2s[program.exps[exp].exp_p2];
+  const Exp_p1 *exp_p1 = &program.exp_p1s[exp_p2->exp_p1];
+
+  std::string key;
+  if (exp_p1->exp_p1_type == Exp_p1::Type::Exp_ac) {
+    key = "\"" + exp_p1->identifier;
+  } else if (exp_p1->exp_p1_type == Exp_p1::Type::Range) {
+    key = {'(', exp_p1->range_low, '-', exp_p1->range_high, ')'};
+  } else {
+    return "";
+  }
+
+  switch (exp_p2->unop_type) {
+  case Exp_p2::Type::KleeneStar:
+    return key + "*";
+  case Exp_p2::Type::PosClos:
+    return key + "+";
+  case Exp_p2::Type::Opt:
+    return key + "?";
+  default:
+    return key;
+  }
+}
+
+/**
+ * CompileExp
+ * @brief Looks up the frozen automaton of an expression, building and
+ * freezing it the first time its key is seen.
+ *
+ * @param program The program the expression belongs to.
+ * @param exp Index of the Exp in the program.
+ * @param cache Automata built so far. Entries are never removed, so the
+ * result stays valid as long as the cache does.
+ * @return The automaton, or nullptr if the expression cannot be built.
+ */
+const FrozenNFA *CompileExp(const Program &program, NodeId exp,
+                            AutomatonCache &cache) {
+  std::string key = ExpKey(program, exp);
+  if (key.empty()) {
+    return nullptr;
+  }
+  auto found = cache.find(key);
+  if (found == cache.end()) {
+    found = cache.emplace(key, freeze(BuildExpNFA(program, exp).start)).first;
+  }
+  return &found->second;
+}
+
+/**
+ * PatternSetKey
+ * @brief Describes the member list of a TESTALL as text, for reusing the
+ * PatternSet built from it.
+ *
+ * @param names The member names, in order.
+ * @return The names joined with commas.
+ */
+std::string PatternSetKey(const std::vector<std::string> &names) {
+  std::string key = "";
+  for (const std::string &name : names) {
+    key += (key.empty() ? "" : ",") + name;
+  }
+  return key;
+}
+
+/**
+ * PatternSetHasMember
+ * @brief Checks whether a variable is one of the members a key lists.
+ *
+ * @param key A key made by PatternSetKey.
+ * @param name The variable name.
+ * @return true if the variable is a member.
+ */
+bool PatternSetHasMember(const std::string &key, const std::string &name) {
+  return ("," + key + ",").find("," + name + ",") != std::string::npos;
+}
+
+/**
+ * Interpreter::Interpreter
+ * @brief Constructor for the Interpreter class.
+ *
+ * @param parsed_program The validated program to run.
+ * @param automaton_cache Automata kept from earlier runs, or nullptr to
+ * build every automaton for this run only.
+ */
+Interpreter::Interpreter(Program &&parsed_program,
+                         AutomatonCache *automaton_cache)
+    : program(std::move(parsed_program)),
+      automata(automaton_cache != nullptr ? automaton_cache : &ownAutomata) {}
+
+/**
+ * Interpreter::run
+ * @brief Runs every instruction in order.
+ *
+ * Prints the same output as the program the code generator would produce.
+ *
+ * @return 0 on success; -1 if an assignment uses an expression that cannot
+ * be built yet.
+ */
+int Interpreter::run() {
+  std::cout << "------------------" << std::endl;
+  std::cout << "* AutomataScript *" << std::endl << std::endl;
+
+  for (const Instruction &instruction : program.instructions) {
+    switch (instruction.inst_type) {
+    case Instruction::Type::Test:
+      runTest(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::TestAll:
+      runTestAll(&std::get<TestAllData>(instruction.data));
+      break;
+    case Instruction::Type::Search:
+      runSearch(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::FindAll:
+      runFindAll(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::TestFile:
+      runTestFile(&std::get<TestData>(instruction.data));
+      break;
+    case Instruction::Type::Print:
+      std::cout << std::get<PrintData>(instruction.data).output_string
+                << std::endl;
+      break;
+    case Instruction::Type::Assign:
+      if (!runAssign(&std::get<AssignData>(instruction.data))) {
+        return -1;
+      }
+      break;
+    case Instruction::Type::Error:
+      std::cout << "ERROR, SHOULD NOT BE HERE!" << std::endl;
+      break;
+    }
+  }
+
+  std::cout << "------------------" << std::endl;
+  return 0;
+}
+
+/**
+ * Interpreter::runTest
+ * @brief Runs a Test instruction and prints whether the NFA accepted.
+ *
+ * @param testData Pointer to TestData containing the NFA name and test value.
+ */
+void Interpreter::runTest(const TestData *testData) {
+  int status = RunNFA(*variables.at(testData->NFA_name), 0,
+                      testData->test_value);
+
+  std::cout << "- " << testData->NFA_name << " <- " << testData->test_value
+            << (status == -1 ? ": Rejected by NFA." : ": Accepted by NFA.")
+            << std::endl;
+}
+
+/**
+ * Interpreter::runTestAll
+ * @brief Runs a TestAll instruction and prints every NFA that accepted.
+ *
+ * The PatternSet of a member list is reused by later TestAlls on the same
+ * list until one of its members is reassigned.
+ *
+ * @param testAllData Pointer to TestAllData containing the NFA names and the
+ * test value.
+ */
+void Interpreter::runTestAll(const TestAllData *testAllData) {
+  std::string names = "";
+  for (const std::string &nfa_name : testAllData->NFA_names) {
+    names += (names.empty() ? "" : ", ") + nfa_name;
+  }
+
+  // Build the set the first time its members are tested together
+  std::string key = PatternSetKey(testAllData->NFA_names);
+  auto found = patternSets.find(key);
+  if (found == patternSets.end()) {
+    std::vector<const FrozenNFA *> patterns;
+    for (const std::string &nfa_name : testAllData->NFA_names) {
+      patterns.push_back(variables.at(nfa_name));
+    }
+    found = patternSets.emplace(key, PatternSet(patterns)).first;
+  }
+  std::vector<int> pattern_ids = found->second.match(testAllData->test_value);
+
+  std::cout << "- " << names << " <- " << testAllData->test_value;
+  if (pattern_ids.empty()) {
+    std::cout << ": Rejected by all." << std::endl;
+    return;
+  }
+  std::cout << ": Accepted by";
+  for (size_t i = 0; i < pattern_ids.size(); i++) {
+    std::cout << (i == 0 ? " " : ", ")
+              << testAllData->NFA_names[pattern_ids[i]];
+  }
+  std::cout << "." << std::endl;
+}
+
+/**
+ * Interpreter::runSearch
+ * @brief Runs a Search instruction and prints the leftmost-longest match.
+ *
+ * @param searchData Pointer to TestData containing the NFA name and the text
+ * to search.
+ */
+void Interpreter::runSearch(const TestData *searchData) {
+  const std::string &input = searchData->test_value;
+  Match match = SearchNFA(searcherOf(searchData->NFA_name), 0, input);
+
+  std::cout << "- " << searchData->NFA_name << " <- " << input;
+  if (match.start == -1) {
+    std::cout << ": No match." << std::endl;
+    return;
+  }
+  std::cout << ": Found " << input.substr(match.start, match.end - match.start)
+            << " at " << match.start << "-" << match.end << "." << std::endl;
+}
+
+/**
+ * Interpreter::runFindAll
+ * @brief Runs a FindAll instruction and prints every match.
+ *
+ * @param findAllData Pointer to TestData containing the NFA name and the text
+ * to search.
+ */
+void Interpreter::runFindAll(const TestData *findAllData) {
+  const std::string &input = findAllData->test_value;
+  std::vector<Match> matches =
+      FindAllNFA(searcherOf(findAllData->NFA_name), input);
+
+  std::cout << "- " << findAllData->NFA_name << " <- " << input << ": "
+            << matches.size() << " matches:";
+  for (const Match &found : matches) {
+    std::cout << " " << input.substr(found.start, found.end - found.start)
+              << "(" << found.start << "-" << found.end << ")";
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * Interpreter::runTestFile
+ * @brief Runs a TestFile instruction: streams the file, or stdin for "-",
+ * through the NFA and prints whether its whole content was accepted.
+ *
+ * @param testFileData Pointer to TestData containing the NFA name and the
+ * path.
+ */
+void Interpreter::runTestFile(const TestData *testFileData) {
+  StreamMatcher matcher(*variables.at(testFileData->NFA_name));
+  const std::string &path = testFileData->test_value;
+  int64_t length = path == "-" ? MatchStream(matcher, std::cin)
+                               : MatchFile(matcher, path);
+
+  std::cout << "- " << testFileData->NFA_name << " <- " << path;
+  if (length == -1) {
+    std::cout << ": Rejected by NFA." << std::endl;
+    return;
+  }
+  std::cout << ": Accepted by NFA (" << length << " bytes)." << std::endl;
+}
+
+/**
+ * Interpreter::runAssign
+ * @brief Looks up the automaton of an assignment and stores it in the
+ * variable. PatternSets the variable is a member of, and its Searcher, are
+ * dropped.
+ *
+ * @param assignData Pointer to AssignData containing the left-hand side and the
+ * expression.
+ * @return false if the expression cannot be built.
+ */
+bool Interpreter::runAssign(const AssignData *assignData) {
+  const FrozenNFA *nfa = CompileExp(program, assignData->rhs, *automata);
+  if (nfa == nullptr) {
+    std::cerr << "Unsupported expression assigned to " << assignData->lhs
+              << std::endl;
+    return false;
+  }
+
+  // Sets and searchers built with the old automaton are stale now
+  searchers.erase(assignData->lhs);
+  for (auto set = patternSets.begin(); set != patternSets.end();) {
+    if (PatternSetHasMember(set->first, assignData->lhs)) {
+      set = patternSets.erase(set);
+    } else {
+      set++;
+    }
+  }
+
+  variables[assignData->lhs] = nfa;
+  return true;
+}
+
+/**
+ * Interpreter::searcherOf
+ * @brief Looks up the Searcher of a variable, building it the first time
+ * the variable is searched after an assignment.
+ *
+ * @param nfa_name Name of the variable.
+ * @return The Searcher, valid until the variable is reassigned.
+ */
+Searcher &Interpreter::searcherOf(const std::string &nfa_name) {
+  auto found = searchers.find(nfa_name);
+  if (found == searchers.end()) {
+    found = searchers.emplace(nfa_name, Searcher(*variables.at(nfa_name)))
+                .first;
+  }
+  return found->second;
+}
@@ -1,4 +1,5 @@
 #include "../include/logger.h"
+#include "../include/tokenize.h"
 
 // Global logger initialization, initialized with output file path
 Logger logger("logs/logfile.log");
@@ -52,12 +53,15 @@ void Logger::log(const std::string &message) {
  * Logger::log_tokens
  * @brief Logs a list of tokens with their corresponding indices.
  *
- * @param tokens A vector of string tokens to be logged.
+ * @param tokens A vector of tokens to be logged.
+ * @param source The source text the tokens were scanned from.
  * Each token is printed on a new line in the format: "<index>: <token>".
  */
-void Logger::log_tokens(std::vector<std::string> tokens) {
-  for (int i = 0; i < tokens.size(); i++) {
-    std::string output = "" + std::to_string(i) + ": " + tokens[i];
+void Logger::log_tokens(const std::vector<Token> &tokens,
+                        std::string_view source) {
+  for (size_t i = 0; i < tokens.size(); i++) {
+    std::string output =
+        std::to_string(i) + ": " + outputToken(tokens[i], source);
     LOG(output);
   }
 }
@@ -1,82 +1,122 @@
-#include "../include/codegen.h"
-#include "../include/logger.h"
-#include "../include/parse.h"
-#include "../include/tokenize.h"
-#include "../include/transpiler_types.h"
-#include "../include/validate.h"
-#include <fstream>
+#include "../include/driver.h"
+#include "../include/server.h"
 #include <iostream>
-#include <vector>
+#include <string>
+
+/**
+ * @brief Parses the command-line options that come before the source file.
+ *
+ * Supported options:
+ *   --engine=nfa|lazydfa|dfa|bitnfa|direct|table
+ *                             Matcher the generated TEST code runs on.
+ *   --dfa-cache=<bytes>       Memory budget for the lazy DFA state cache.
+ *   --stats                   Generated program reports automaton sizes.
+ *   --fold-tests              Evaluate TESTs while transpiling; if nothing
+ *                             is left to run, skip compiling altogether.
+ *   --interpret               Run the script in-process instead of
+ *                             generating and compiling C++.
+ *   --cache-size=<bytes>      Size cap of the compiled binary cache; 0
+ *                             disables it.
+ *   --cache-stats             Report cache hits and size to stderr.
+ *   --serve[=<socket>]        Stay resident and run the scripts requested on
+ *                             stdin, or on a Unix socket; see Server.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @param options Receives the parsed code generation settings.
+ * @param driver Receives the settings of the transpiler itself.
+ * @param source_file Receives the path of the script to transpile. Servers
+ * take none.
+ * @return true if the arguments are valid; otherwise, false.
+ */
+static bool parseArguments(int argc, char *argv[], CodegenOptions &options,
+                           DriverOptions &driver, std::string &source_file) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "--engine=nfa") {
+      options.engine = CodegenOptions::Engine::NFA;
+    } else if (arg == "--engine=lazydfa") {
+      options.engine = CodegenOptions::Engine::LazyDFA;
+    } else if (arg == "--engine=dfa") {
+      options.engine = CodegenOptions::Engine::DFA;
+    } else if (arg == "--engine=bitnfa") {
+      options.engine = CodegenOptions::Engine::BitNFA;
+    } else if (arg == "--engine=direct") {
+      options.engine = CodegenOptions::Engine::Direct;
+    } else if (arg == "--engine=table") {
+      options.engine = CodegenOptions::Engine::Table;
+    } else if (arg == "--fold-tests") {
+      options.foldTests = true;
+    } else if (arg == "--interpret") {
+      driver.interpret = true;
+    } else if (arg == "--cache-stats") {
+      driver.cacheStats = true;
+    } else if (arg.rfind("--cache-size=", 0) == 0) {
+      try {
+        driver.cacheBudget = std::stoull(arg.substr(13));
+      } catch (const std::exception &) {
+        return false;
+      }
+    } else if (arg == "--serve") {
+      driver.serve = true;
+    } else if (arg.rfind("--serve=", 0) == 0) {
+      driver.serve = true;
+      driver.serveSocket = arg.substr(8);
+      if (driver.serveSocket.empty()) {
+        return false;
+      }
+    } else if (arg == "--stats") {
+      options.reportStats = true;
+    } else if (arg.rfind("--dfa-cache=", 0) == 0) {
+      try {
+        options.dfaCacheBudget = std::stoul(arg.substr(12));
+      } catch (const std::exception &) {
+        return false;
+      }
+    } else if (arg.rfind("--", 0) == 0 || !source_file.empty()) {
+      return false;
+    } else {
+      source_file = arg;
+    }
+  }
+
+  return driver.serve == source_file.empty();
+}
 
 /**
  * @brief Main entry point for the transpiler.
  *
  * This program reads a source file, tokenizes its content, parses the tokens
  * into an AST, validates the instructions, and then generates and compiles C++
- * code.
+ * code. With --serve it stays resident and does so for every script a client
+ * sends.
  *
  * @param argc The number of command-line arguments.
  * @param argv Array of command-line arguments.
  * @return int Exit status of the program.
  */
 int main(int argc, char *argv[]) {
-  if (argc != 2) {
-    std::cerr << "Usage: " << argv[0] << " <source_file>\n";
-    return 1;
-  }
-
-  std::ifstream source(argv[1]);
-  if (!source) {
-    std::cerr << "Failed to open the file.\n";
-    return 1;
-  }
-
-  // Read the entire file into a string
-  std::string input((std::istreambuf_iterator<char>(source)),
-                    std::istreambuf_iterator<char>());
-
-  // Tokenize everything. This should return a vector with all the tokens
-  std::vector<std::string> tokens = mainTokenizer(input);
-  if (tokens[0].substr(0, 4) == "ERRO") {
-    // TODO: Add better error prints
-    std::cout << tokens[0] << std::endl;
+  CodegenOptions options;
+  DriverOptions driverOptions;
+  std::string source_file;
+  if (!parseArguments(argc, argv, options, driverOptions, source_file)) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--engine=nfa|lazydfa|dfa|bitnfa|direct|table]"
+              << " [--dfa-cache=<bytes>] [--stats] [--fold-tests]"
+              << " [--interpret] [--cache-size=<bytes>] [--cache-stats]"
+              << " <source_file> | --serve[=<socket>]\n";
     return 1;
   }
-  logger.log_tokens(tokens);
 
-  // Take the tokens, turn into AST.
-  Parser parser(tokens);
-  std::vector<Instruction> all_instructions = parser.mainParser();
-  if (all_instructions[0].inst_type == Instruction::Type::Error) {
-    std::cout << "Parsing error at index "
-              << ((ErrorData *)all_instructions[0].data)->error_index
-              << std::endl;
-    return 1;
-  }
-
-  // Validation phase
-  // If parsing is successful, there may be places that are invalid, e.g.
-  // attempting to access an unused variable, etc.
-  Validator validator(all_instructions);
-  int validate_status = validator.validate();
-  if (validate_status == -1) {
-    std::cout << "Validation error" << std::endl;
-    return 1;
+  Driver driver(options, driverOptions);
+  if (!driverOptions.serve) {
+    return driver.runFile(source_file);
   }
 
-  // Generate the C++ code, store it in file location
-  CodeGenerator codegen("bin/tmp/", all_instructions);
-  codegen.generateCode();
-
-  // Compile & run generated code
-  std::string cppDirectory = "bin/tmp/";
-  std::string binaryName = "./bin/compiled_output";
-  std::string compileCommand = "make -C bin/tmp/";
-  if (std::system(compileCommand.c_str()) != 0) {
-    std::cerr << "Compilation failed!\n";
-    return 2;
+  Server server(driver);
+  if (driverOptions.serveSocket.empty()) {
+    return server.serveStdin();
   }
-  std::system(binaryName.c_str());
-
-  return 0;
+  return server.serveSocket(driverOptions.serveSocket);
 }
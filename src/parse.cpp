@@ -15,9 +15,11 @@ int parsing_index;
  * Initializes the parser with a list of tokens and resets the parsing index.
  *
  * @param token_list The vector of tokens to parse.
+ * @param source_text The source text the tokens are spans of.
  */
-Parser::Parser(const std::vector<std::string> &token_list)
-    : tokens(token_list) {
+Parser::Parser(const std::vector<Token> &token_list,
+               std::string_view source_text)
+    : tokens(token_list), source(source_text) {
 
   this->parsing_index = 0;
   this->total_tokens = token_list.size();
@@ -29,57 +31,92 @@ Parser::Parser(const std::vector<std::string> &token_list)
  * @brief Top-level parser that processes tokens into a vector of instructions.
  *
  * Scans through the token stream, dispatching to appropriate parsing functions
- * for Print, Test, and variable instructions.
+ * for Print, Test, TestAll, Search, FindAll, TestFile, and variable
+ * instructions.
  *
- * @return A vector of Instruction objects.
+ * @return The parsed Program, whose instructions are moved out of the parser.
  */
-std::vector<Instruction> Parser::mainParser() {
-  std::vector<Instruction> instructions;
-  std::string token;
+Program Parser::mainParser() {
+  std::vector<Instruction> &instructions = program.instructions;
+  TokenKind token;
   int err_val;
 
   while (parsing_index < total_tokens) {
-    token = tokens[parsing_index];
+    token = currentKind();
 
     // Handle Print
-    if (token == "Print") {
+    if (token == TokenKind::Print) {
       err_val = consumeToken();
       if (err_val != NO_ERR) {
-        return generateErrorIV(err_val);
+        return generateErrorProgram(err_val);
       }
 
       Instruction printInst = parsePrint();
-      instructions.push_back(printInst);
+      instructions.push_back(std::move(printInst));
     }
 
     // Handle Test
-    else if (token == "Test") {
+    else if (token == TokenKind::Test) {
       err_val = consumeToken();
       if (err_val != NO_ERR) {
-        return generateErrorIV(err_val);
+        return generateErrorProgram(err_val);
       }
 
-      Instruction testInst = parseTest();
-      instructions.push_back(testInst);
+      Instruction testInst = parseTest(Instruction::Type::Test);
+      instructions.push_back(std::move(testInst));
+    }
+
+    // Handle TestAll, Test against several variables at once
+    else if (token == TokenKind::TestAll) {
+      err_val = consumeToken();
+      if (err_val != NO_ERR) {
+        return generateErrorProgram(err_val);
+      }
+
+      Instruction testAllInst = parseTestAll();
+      instructions.push_back(std::move(testAllInst));
+    }
+
+    // Handle Search and FindAll, same syntax as Test
+    else if (token == TokenKind::Search || token == TokenKind::FindAll) {
+      err_val = consumeToken();
+      if (err_val != NO_ERR) {
+        return generateErrorProgram(err_val);
+      }
+
+      Instruction searchInst =
+          parseTest(token == TokenKind::Search ? Instruction::Type::Search
+                                      : Instruction::Type::FindAll);
+      instructions.push_back(std::move(searchInst));
+    }
+
+    // Handle TestFile, same syntax as Test with a path as the value
+    else if (token == TokenKind::TestFile) {
+      err_val = consumeToken();
+      if (err_val != NO_ERR) {
+        return generateErrorProgram(err_val);
+      }
+
+      Instruction testFileInst = parseTest(Instruction::Type::TestFile);
+      instructions.push_back(std::move(testFileInst));
     }
 
     // Handle Variable
-    else if (token.substr(0, 3) == "Id(") {
+    else if (token == TokenKind::Id) {
       // No consume, need to use Id in recursive call
 
       Instruction varInst = parseVar();
-      instructions.push_back(varInst);
-      std::string currToken = tokens[parsing_index];
+      instructions.push_back(std::move(varInst));
     }
 
     // Invalid, return.
     else {
       // Set up structure to pass back error info
-      return generateErrorIV(parsing_index);
+      return generateErrorProgram(parsing_index);
     }
   }
 
-  return instructions;
+  return std::move(program);
 };
 
 /**
@@ -93,11 +130,11 @@ std::vector<Instruction> Parser::mainParser() {
  * @return An Instruction object for a Print operation.
  */
 Instruction Parser::parsePrint() {
-  std::string currToken;
+  TokenKind currToken;
 
   // Parsing `:`
-  currToken = tokens[parsing_index];
-  if (currToken != "Colon") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Colon) {
     return generateErrorInstruction(parsing_index);
   }
   int err_val = consumeToken();
@@ -108,22 +145,23 @@ Instruction Parser::parsePrint() {
   // Parsing Id()*
   std::string output_string = "- ";
   while (1) {
-    currToken = tokens[parsing_index];
+    currToken = currentKind();
+    if (currToken == TokenKind::Id) {
+      output_string += currentText();
+      output_string += " ";
+    }
     err_val = consumeToken();
     if (err_val != NO_ERR) {
       return generateErrorInstruction(err_val);
     }
 
-    if (currToken.substr(0, 3) != "Id(") {
+    if (currToken != TokenKind::Id) {
       break;
     }
-
-    output_string += currToken.substr(3, currToken.length() - 4);
-    output_string += " ";
   }
 
   // Parsing `;`
-  if (currToken != "Semicolon") {
+  if (currToken != TokenKind::Semicolon) {
     return generateErrorInstruction(parsing_index);
   }
   if (err_val != NO_ERR) {
@@ -131,8 +169,7 @@ Instruction Parser::parsePrint() {
   }
 
   // Setting data for the instruction for vector
-  PrintData *print_data = new PrintData(output_string);
-  Instruction inst_out(Instruction::Type::Print, print_data);
+  Instruction inst_out(Instruction::Type::Print, PrintData(output_string));
 
   return inst_out;
 }
@@ -154,17 +191,47 @@ int Parser::consumeToken() {
 }
 
 /**
- * Parser::generateErrorIV
+ * Parser::currentKind
  *
- * @brief Generates an instruction vector containing a single error instruction.
+ * @brief Returns the kind of the token at the parsing index.
+ *
+ * @return The token's kind, or End once every token has been consumed.
+ */
+TokenKind Parser::currentKind() {
+  if (parsing_index >= total_tokens) {
+    return TokenKind::End;
+  }
+  return tokens[parsing_index].kind;
+}
+
+/**
+ * Parser::currentText
+ *
+ * @brief Returns the source text of the token at the parsing index.
+ *
+ * @return The token's lexeme, or an empty string once every token has been
+ * consumed.
+ */
+std::string Parser::currentText() {
+  if (parsing_index >= total_tokens) {
+    return "";
+  }
+  const Token &token = tokens[parsing_index];
+  return std::string(source.substr(token.offset, token.length));
+}
+
+/**
+ * Parser::generateErrorProgram
+ *
+ * @brief Generates a program containing a single error instruction.
  *
  * @param err_val The error value or index where the error occurred.
- * @return A vector of Instruction objects containing the error.
+ * @return A Program whose only instruction is the error.
  */
-std::vector<Instruction> Parser::generateErrorIV(int err_val) {
-  std::vector<Instruction> err_instruction;
-  err_instruction.push_back(generateErrorInstruction(err_val));
-  return err_instruction;
+Program Parser::generateErrorProgram(int err_val) {
+  Program err_program;
+  err_program.instructions.push_back(generateErrorInstruction(err_val));
+  return err_program;
 }
 
 /**
@@ -176,8 +243,8 @@ std::vector<Instruction> Parser::generateErrorIV(int err_val) {
  * @return An Instruction object representing an error.
  */
 Instruction Parser::generateErrorInstruction(int err_val) {
-  ErrorData *err_data = new ErrorData(ErrorData::Type::ParsingError, err_val);
-  Instruction err_inst(Instruction::Type::Error, err_data);
+  Instruction err_inst(Instruction::Type::Error,
+                       ErrorData(ErrorData::Type::ParsingError, err_val));
 
   return err_inst;
 }
@@ -185,19 +252,21 @@ Instruction Parser::generateErrorInstruction(int err_val) {
 /**
  * Parser::parseTest
  *
- * @brief Parses a Test instruction.
+ * @brief Parses a Test, Search, FindAll or TestFile instruction.
  *
  * Expected syntax:
  *   Test : Id("...") Runner Quotation Id("...") Quotation Semicolon
+ * TestFile takes a path between the quotes instead, see parseFilePath.
  *
- * @return An Instruction object for a Test operation.
+ * @param inst_type Which of the four instructions is being parsed.
+ * @return An Instruction object for the operation.
  */
-Instruction Parser::parseTest() {
-  std::string currToken;
+Instruction Parser::parseTest(Instruction::Type inst_type) {
+  TokenKind currToken;
 
   // Parsing `:`
-  currToken = tokens[parsing_index];
-  if (currToken != "Colon") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Colon) {
     return generateErrorInstruction(parsing_index);
   }
   int err_val = consumeToken();
@@ -207,72 +276,232 @@ Instruction Parser::parseTest() {
 
   // Parsing lval
   std::string nfa_name = "";
-  currToken = tokens[parsing_index];
-  if (currToken.substr(0, 3) != "Id(") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Id) {
     return generateErrorInstruction(parsing_index);
   }
-  nfa_name += currToken.substr(3, currToken.length() - 4);
+  nfa_name += currentText();
   err_val = consumeToken();
   if (err_val != NO_ERR) {
     return generateErrorInstruction(err_val);
   }
 
-  // Parsing "<<"
-  currToken = tokens[parsing_index];
-  if (currToken != "Runner") {
+  // Parsing << "..." ;
+  std::string test_value = "";
+  err_val = inst_type == Instruction::Type::TestFile
+                ? parseFilePath(test_value)
+                : parseTestValue(test_value);
+  if (err_val != NO_ERR) {
+    return generateErrorInstruction(err_val);
+  }
+
+  // Setting data for the instruction for vector
+  Instruction inst_out(inst_type, TestData(nfa_name, test_value));
+
+  return inst_out;
+}
+
+/**
+ * Parser::parseTestAll
+ *
+ * @brief Parses a TestAll instruction.
+ *
+ * Expected syntax:
+ *   TestAll : Id("...") (Comma Id("..."))* Runner Quotation Id("...")
+ *   Quotation Semicolon
+ *
+ * @return An Instruction object for a TestAll operation.
+ */
+Instruction Parser::parseTestAll() {
+  TokenKind currToken;
+
+  // Parsing `:`
+  currToken = currentKind();
+  if (currToken != TokenKind::Colon) {
     return generateErrorInstruction(parsing_index);
   }
-  err_val = consumeToken(); // Consume "<<"
+  int err_val = consumeToken();
   if (err_val != NO_ERR) {
     return generateErrorInstruction(err_val);
   }
 
+  // Parsing lval (`,` lval)*
+  std::vector<std::string> nfa_names;
+  while (1) {
+    currToken = currentKind();
+    if (currToken != TokenKind::Id) {
+      return generateErrorInstruction(parsing_index);
+    }
+    nfa_names.push_back(currentText());
+    err_val = consumeToken();
+    if (err_val != NO_ERR) {
+      return generateErrorInstruction(err_val);
+    }
+
+    if (currentKind() != TokenKind::Comma) {
+      break;
+    }
+    err_val = consumeToken(); // Consume `,`
+    if (err_val != NO_ERR) {
+      return generateErrorInstruction(err_val);
+    }
+  }
+
+  // Parsing << "..." ;
+  std::string test_value = "";
+  err_val = parseTestValue(test_value);
+  if (err_val != NO_ERR) {
+    return generateErrorInstruction(err_val);
+  }
+
+  return Instruction(Instruction::Type::TestAll,
+                     TestAllData(nfa_names, test_value));
+}
+
+/**
+ * Parser::parseTestValue
+ *
+ * @brief Parses the input a Test-like instruction is run on, up to and
+ * including the closing semicolon.
+ *
+ * Expected syntax:
+ *   Runner Quotation Id("...")? Quotation Semicolon
+ *
+ * @param test_value Receives the text between the quotation marks.
+ * @return NO_ERR if successful; otherwise, the index of the offending token.
+ */
+int Parser::parseTestValue(std::string &test_value) {
+  TokenKind currToken;
+
+  // Parsing "<<"
+  currToken = currentKind();
+  if (currToken != TokenKind::Runner) {
+    return parsing_index;
+  }
+  int err_val = consumeToken(); // Consume "<<"
+  if (err_val != NO_ERR) {
+    return err_val;
+  }
+
   // Parsing "
-  currToken = tokens[parsing_index];
-  if (currToken != "Quotation") {
-    return generateErrorInstruction(parsing_index);
+  currToken = currentKind();
+  if (currToken != TokenKind::Quotation) {
+    return parsing_index;
   }
   err_val = consumeToken(); // Consume "
   if (err_val != NO_ERR) {
-    return generateErrorInstruction(err_val);
+    return err_val;
   }
 
   // Parsing Id()
-  std::string test_value = "";
-  currToken = tokens[parsing_index];
-  if (currToken.substr(0, 3) == "Id(") {
-    test_value += currToken.substr(3, currToken.length() - 4);
+  currToken = currentKind();
+  if (currToken == TokenKind::Id) {
+    test_value += currentText();
     err_val = consumeToken();
     if (err_val != NO_ERR) {
-      return generateErrorInstruction(err_val);
+      return err_val;
     }
   }
 
   // Parsing "
-  currToken = tokens[parsing_index];
-  if (currToken != "Quotation") {
-    return generateErrorInstruction(parsing_index);
+  currToken = currentKind();
+  if (currToken != TokenKind::Quotation) {
+    return parsing_index;
   }
   err_val = consumeToken(); // Consume "
   if (err_val != NO_ERR) {
-    return generateErrorInstruction(err_val);
+    return err_val;
   }
 
   // Parsing `;`
-  currToken = tokens[parsing_index];
-  if (currToken != "Semicolon") {
-    return generateErrorInstruction(parsing_index);
+  currToken = currentKind();
+  if (currToken != TokenKind::Semicolon) {
+    return parsing_index;
   }
   err_val = consumeToken(); // Consume semicolon
   if (err_val != NO_ERR) {
-    return generateErrorInstruction(err_val);
+    return err_val;
   }
 
-  // Setting data for the instruction for vector
-  TestData *test_data = new TestData(nfa_name, test_value);
-  Instruction inst_out(Instruction::Type::Test, test_data);
+  return NO_ERR;
+}
 
-  return inst_out;
+/**
+ * Parser::parseFilePath
+ *
+ * @brief Parses the path of a TestFile instruction.
+ *
+ * Expected syntax:
+ *   Runner Quotation (Id | Num | Dash | Dot | Slash)+ Quotation Semicolon
+ * The path is the source text between the quotes, so "-" names stdin and
+ * "tests/data/input.txt" a file.
+ *
+ * @param path Receives the path.
+ * @return NO_ERR if successful; otherwise, the index of the offending token.
+ */
+int Parser::parseFilePath(std::string &path) {
+  TokenKind currToken;
+
+  // Parsing "<<"
+  currToken = currentKind();
+  if (currToken != TokenKind::Runner) {
+    return parsing_index;
+  }
+  int err_val = consumeToken(); // Consume "<<"
+  if (err_val != NO_ERR) {
+    return err_val;
+  }
+
+  // Parsing "
+  currToken = currentKind();
+  if (currToken != TokenKind::Quotation) {
+    return parsing_index;
+  }
+  err_val = consumeToken(); // Consume "
+  if (err_val != NO_ERR) {
+    return err_val;
+  }
+
+  // Parsing the tokens that make up the path
+  size_t first = parsing_index;
+  currToken = currentKind();
+  while (currToken == TokenKind::Id || currToken == TokenKind::Num ||
+         currToken == TokenKind::Dash || currToken == TokenKind::Dot ||
+         currToken == TokenKind::Slash) {
+    err_val = consumeToken();
+    if (err_val != NO_ERR) {
+      return err_val;
+    }
+    currToken = currentKind();
+  }
+  if (parsing_index == first) {
+    return parsing_index;
+  }
+  const Token &start = tokens[first];
+  const Token &last = tokens[parsing_index - 1];
+  path = std::string(source.substr(
+      start.offset, last.offset + last.length - start.offset));
+
+  // Parsing "
+  if (currToken != TokenKind::Quotation) {
+    return parsing_index;
+  }
+  err_val = consumeToken(); // Consume "
+  if (err_val != NO_ERR) {
+    return err_val;
+  }
+
+  // Parsing `;`
+  currToken = currentKind();
+  if (currToken != TokenKind::Semicolon) {
+    return parsing_index;
+  }
+  err_val = consumeToken(); // Consume semicolon
+  if (err_val != NO_ERR) {
+    return err_val;
+  }
+
+  return NO_ERR;
 }
 
 /**
@@ -287,23 +516,23 @@ Instruction Parser::parseTest() {
  */
 Instruction Parser::parseVar() {
   int err_val;
-  std::string currToken;
+  TokenKind currToken;
 
   // Parsing Id()
   std::string lhs = "";
-  currToken = tokens[parsing_index];
-  if (currToken.substr(0, 3) != "Id(") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Id) {
     return generateErrorInstruction(parsing_index);
   }
-  lhs += currToken.substr(3, currToken.length() - 4);
+  lhs += currentText();
   err_val = consumeToken();
   if (err_val != NO_ERR) {
     return generateErrorInstruction(err_val);
   }
 
   // Parsing `=`
-  currToken = tokens[parsing_index];
-  if (currToken != "Assign") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Assign) {
     return generateErrorInstruction(parsing_index);
   }
   err_val = consumeToken();
@@ -312,14 +541,13 @@ Instruction Parser::parseVar() {
   }
 
   // Parsing rhs
-  Exp *expression = parseRhs(); // TODO: parseRhs
-  if (expression->exp_p2 == nullptr) {
+  NodeId expression = parseRhs(); // TODO: parseRhs
+  if (expression == NO_NODE) {
     return generateErrorInstruction(parsing_index);
   }
 
   // Setting data for the instruction for vector
-  AssignData *assign_data = new AssignData(lhs, expression);
-  Instruction inst_out(Instruction::Type::Assign, assign_data);
+  Instruction inst_out(Instruction::Type::Assign, AssignData(lhs, expression));
 
   return inst_out;
 }
@@ -331,28 +559,30 @@ Instruction Parser::parseVar() {
  * Begins by parsing an Exp_p2 expression and then checks for additional binary
  * operations.
  *
- * @return A pointer to an Exp representing the parsed expression.
+ * @return The index of the parsed Exp, or NO_NODE on error.
  * @warn WARN: Incomplete!
  * @todo TODO: Loop to handle additional binary operations.
  */
-Exp *Parser::parseRhs() {
+NodeId Parser::parseRhs() {
   // Start by getting exp_p2
-  std::string currToken;
-  Exp_p2 *p2_exp = parseExp_p2();
-  Exp *expression = new Exp(p2_exp);
+  TokenKind currToken;
+  NodeId p2_exp = parseExp_p2();
+  if (p2_exp == NO_NODE) {
+    return NO_NODE;
+  }
 
   // TODO: Loop to see if there are any further expressions for binop_exp_p2s
 
-  currToken = tokens[parsing_index];
-  if (currToken != "Semicolon") {
+  currToken = currentKind();
+  if (currToken != TokenKind::Semicolon) {
     // TODO: Better return
-    return nullptr;
+    return NO_NODE;
   }
   int err_val = consumeToken();
   if (err_val != NO_ERR) {
-    return nullptr;
+    return NO_NODE;
   }
-  return expression;
+  return program.addExp(Exp(p2_exp));
 }
 
 /**
@@ -363,51 +593,50 @@ Exp *Parser::parseRhs() {
  * First, parses an Exp_p1 expression and then checks for an optional unary
  * operator.
  *
- * @return A pointer to an Exp_p2 representing the parsed expression.
+ * @return The index of the parsed Exp_p2, or NO_NODE on error.
  * @warn WARN: Incomplete!
  * @todo TODO: Add binary operator checking.
  */
-Exp_p2 *Parser::parseExp_p2() {
+NodeId Parser::parseExp_p2() {
   int err;
 
   // Get p1 expression
-  Exp_p1 *p1_exp = parseExp_p1();
+  NodeId p1_exp = parseExp_p1();
+  if (p1_exp == NO_NODE) {
+    return NO_NODE;
+  }
 
   // Check if the unop exists (optional)
-  std::string token = tokens[parsing_index];
-  if (token == "Star") {
+  TokenKind token = currentKind();
+  if (token == TokenKind::Star) {
     // This exists!, so consume the token
     err = consumeToken();
     if (err != NO_ERR) {
       // TODO: Improve error handling
-      return nullptr;
+      return NO_NODE;
     }
     // KleeneStar
-    Exp_p2 *p2_exp = new Exp_p2(p1_exp, Exp_p2::Type::KleeneStar);
-    return p2_exp;
-  } else if (token == "Plus") {
+    return program.addExp_p2(Exp_p2(p1_exp, Exp_p2::Type::KleeneStar));
+  } else if (token == TokenKind::Plus) {
     // Positional Closure
     err = consumeToken();
     if (err != NO_ERR) {
       // TODO: Improve error handling
-      return nullptr;
+      return NO_NODE;
     }
-    Exp_p2 *p2_exp = new Exp_p2(p1_exp, Exp_p2::Type::PosClos);
-    return p2_exp;
-  } else if (token == "Question") {
+    return program.addExp_p2(Exp_p2(p1_exp, Exp_p2::Type::PosClos));
+  } else if (token == TokenKind::Question) {
     // Optional
     err = consumeToken();
     if (err != NO_ERR) {
       // TODO: Improve error handling
-      return nullptr;
+      return NO_NODE;
     }
-    Exp_p2 *p2_exp = new Exp_p2(p1_exp, Exp_p2::Type::Opt);
-    return p2_exp;
+    return program.addExp_p2(Exp_p2(p1_exp, Exp_p2::Type::Opt));
   }
 
   // If it doesn't exist, return with type None
-  Exp_p2 *p2_exp = new Exp_p2(p1_exp);
-  return p2_exp;
+  return program.addExp_p2(Exp_p2(p1_exp));
 }
 
 /**
@@ -417,60 +646,141 @@ Exp_p2 *Parser::parseExp_p2() {
  *
  * Currently supports only a subset:
  *   - Literal expressions enclosed in Quotation marks.
+ *   - Character ranges such as (a-z) or ("a"-"z").
  *
- * @return A pointer to an Exp_p1 representing the parsed expression.
+ * @return The index of the parsed Exp_p1, or NO_NODE on error.
  * @warn WARN: Incomplete!
  * @todo TODO: Add support for ( exp ), lval, and other cases.
  */
-Exp_p1 *Parser::parseExp_p1() {
+NodeId Parser::parseExp_p1() {
   // Idea: Check next token. Match to any possible case.
   // If no case matches, there is an error here.
   // TODO: ( exp )
-  Exp_p1 *p1_exp = new Exp_p1();
-  std::string currToken = tokens[parsing_index];
+  Exp_p1 p1_exp;
+  TokenKind currToken = currentKind();
   int err_val;
 
   // exp_ac (Id())
-  if (currToken == "Quotation") {
+  if (currToken == TokenKind::Quotation) {
     // Only path that can exist for Quotation
     err_val = consumeToken();
     if (err_val != NO_ERR) {
-      // TODO: Add better return types than just nullptr
-      return nullptr;
+      // TODO: Add better return types than just NO_NODE
+      return NO_NODE;
     }
 
     // Parsing Id
     std::string literal = "";
-    currToken = tokens[parsing_index];
-    if (currToken.substr(0, 3) != "Id(") {
+    currToken = currentKind();
+    if (currToken != TokenKind::Id) {
       // TODO: Better return
-      return nullptr;
+      return NO_NODE;
     }
-    literal += currToken.substr(3, currToken.length() - 4);
+    literal += currentText();
     err_val = consumeToken();
     if (err_val != NO_ERR) {
       // TODO: Better return
-      return nullptr;
+      return NO_NODE;
     }
 
     // Parsing closing quote
-    currToken = tokens[parsing_index];
-    if (currToken != "Quotation") {
+    currToken = currentKind();
+    if (currToken != TokenKind::Quotation) {
       // TODO: Better return
-      return nullptr;
+      return NO_NODE;
     }
     err_val = consumeToken();
     if (err_val != NO_ERR) {
       // TODO: Better return
-      return nullptr;
+      return NO_NODE;
+    }
+
+    p1_exp.exp_p1_type = Exp_p1::Type::Exp_ac;
+    p1_exp.identifier = literal;
+  }
+
+  // `(` bound `-` bound `)`
+  else if (currToken == TokenKind::OpenParen) {
+    err_val = consumeToken();
+    if (err_val != NO_ERR) {
+      return NO_NODE;
+    }
+
+    char low, high;
+    if (parseRangeBound(low) != NO_ERR) {
+      return NO_NODE;
+    }
+
+    currToken = currentKind();
+    if (currToken != TokenKind::Dash) {
+      return NO_NODE;
+    }
+    err_val = consumeToken();
+    if (err_val != NO_ERR) {
+      return NO_NODE;
+    }
+
+    if (parseRangeBound(high) != NO_ERR || low > high) {
+      return NO_NODE;
+    }
+
+    currToken = currentKind();
+    if (currToken != TokenKind::CloseParen) {
+      return NO_NODE;
+    }
+    err_val = consumeToken();
+    if (err_val != NO_ERR) {
+      return NO_NODE;
     }
 
-    p1_exp->exp_p1_type = Exp_p1::Type::Exp_ac;
-    p1_exp->identifier = literal;
+    p1_exp.exp_p1_type = Exp_p1::Type::Range;
+    p1_exp.range_low = low;
+    p1_exp.range_high = high;
   } else {
     // TODO: add other cases here (e.g. ( exp ), lval, etc)
-    return nullptr;
+    return NO_NODE;
   }
 
-  return p1_exp;
+  return program.addExp_p1(std::move(p1_exp));
+}
+
+/**
+ * Parser::parseRangeBound
+ *
+ * @brief Parses one bound of a character range.
+ *
+ * Expected syntax:
+ *   Id(c) | Num(c) | Quotation Id(c) Quotation
+ * where c is a single character.
+ *
+ * @param bound Receives the bound character.
+ * @return NO_ERR if successful; otherwise, the index of the offending token.
+ */
+int Parser::parseRangeBound(char &bound) {
+  TokenKind currToken = currentKind();
+  bool quoted = currToken == TokenKind::Quotation;
+  if (quoted) {
+    if (consumeToken() != NO_ERR) {
+      return parsing_index;
+    }
+    currToken = currentKind();
+  }
+
+  // Id(c) or Num(c) holding a single character
+  if ((currToken != TokenKind::Id && currToken != TokenKind::Num) ||
+      tokens[parsing_index].length != 1) {
+    return parsing_index;
+  }
+  bound = currentText()[0];
+  if (consumeToken() != NO_ERR) {
+    return parsing_index;
+  }
+
+  if (quoted) {
+    if (currentKind() != TokenKind::Quotation || consumeToken() != NO_ERR) {
+      return parsing_index;
+    }
+  }
+
+  return NO_ERR;
 }
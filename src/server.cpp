@@ -0,0 +1,196 @@
+#include "../include/server.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* Connections the socket queues while a script is running */
+#define SERVER_BACKLOG 64
+
+/* Largest script a source request may carry, in bytes */
+#define SERVER_MAX_SOURCE (64 * 1024 * 1024)
+
+/* Bytes of a script read at a time */
+#define SERVER_READ_CHUNK (64 * 1024)
+
+/**
+ * Server::Server
+ * @brief Constructor for the Server class.
+ *
+ * @param script_driver The driver every script is run through.
+ */
+Server::Server(Driver &script_driver) : driver(script_driver) {}
+
+/**
+ * Server::serveStdin
+ * @brief Serves the requests read from stdin. Output goes to stdout.
+ *
+ * @return 0 once stdin ends or a client quits.
+ */
+int Server::serveStdin() {
+  serveRequests(stdin);
+  return 0;
+}
+
+/**
+ * Server::serveSocket
+ * @brief Listens on a Unix socket and serves one connection at a time.
+ *
+ * While a connection is served, stdout and stderr are pointed at it, so the
+ * output of generated programs reaches the client along with everything the
+ * transpiler prints.
+ *
+ * @param socket_path Path of the socket. A stale socket there is replaced.
+ * @return 0 once a client quits; 1 if the socket cannot be set up.
+ */
+int Server::serveSocket(const std::string &socket_path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: " << socket_path << std::endl;
+    return 1;
+  }
+  strcpy(address.sun_path, socket_path.c_str());
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(socket_path.c_str());
+  if (listener < 0 ||
+      bind(listener, (sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(listener, SERVER_BACKLOG) != 0) {
+    perror(socket_path.c_str());
+    return 1;
+  }
+  // A client that hangs up early must not take the server down
+  signal(SIGPIPE, SIG_IGN);
+
+  bool running = true;
+  while (running) {
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("accept");
+      break;
+    }
+
+    std::cout.flush();
+    fflush(stdout);
+    int savedOut = dup(STDOUT_FILENO);
+    int savedErr = dup(STDERR_FILENO);
+    dup2(client, STDOUT_FILENO);
+    dup2(client, STDERR_FILENO);
+
+    FILE *requests = fdopen(client, "r");
+    running = serveRequests(requests);
+
+    std::cout.flush();
+    fflush(stdout);
+    dup2(savedOut, STDOUT_FILENO);
+    dup2(savedErr, STDERR_FILENO);
+    close(savedOut);
+    close(savedErr);
+    fclose(requests);
+  }
+
+  close(listener);
+  unlink(socket_path.c_str());
+  return 0;
+}
+
+/**
+ * Server::serveRequests
+ * @brief Runs requests until the stream ends or a client quits.
+ *
+ * @param requests The stream requests are read from.
+ * @return false if a client asked the server to quit.
+ */
+bool Server::serveRequests(FILE *requests) {
+  char *line = nullptr;
+  size_t capacity = 0;
+  bool running = true;
+  while (getline(&line, &capacity, requests) > 0) {
+    std::string request = line;
+    while (!request.empty() &&
+           (request.back() == '\n' || request.back() == '\r')) {
+      request.pop_back();
+    }
+    if (request.empty()) {
+      continue;
+    }
+    if (request == "quit") {
+      running = false;
+      break;
+    }
+
+    int status = runRequest(request, requests);
+    std::cout << SERVER_DONE_MARKER << status << std::endl;
+  }
+  free(line);
+  return running;
+}
+
+/**
+ * Server::runRequest
+ * @brief Runs the script a request names or carries.
+ *
+ * @param request The request line, without its newline.
+ * @param requests The stream, which holds the script of a source request.
+ * @return The exit status of the script, as the one-shot transpiler would
+ * return it; 1 for malformed requests and for scripts over
+ * SERVER_MAX_SOURCE bytes.
+ */
+int Server::runRequest(const std::string &request, FILE *requests) {
+  if (request.rfind("run ", 0) == 0) {
+    return driver.runFile(request.substr(4));
+  }
+
+  if (request.rfind("source ", 0) == 0) {
+    // Only plain digits; stoull would also take a sign and wrap "-1"
+    std::string digits = request.substr(7);
+    bool valid = !digits.empty() &&
+                 digits.find_first_not_of("0123456789") == std::string::npos;
+    size_t length = 0;
+    try {
+      if (valid) {
+        length = std::stoull(digits);
+      }
+    } catch (const std::out_of_range &) {
+      valid = false;
+    }
+    if (!valid || length > SERVER_MAX_SOURCE) {
+      std::cerr << "Invalid source length: " << request << std::endl;
+      return 1;
+    }
+
+    // Grow the script as it arrives, so a short stream never costs the
+    // whole announced length
+    std::string input;
+    char chunk[SERVER_READ_CHUNK];
+    try {
+      while (input.size() < length) {
+        size_t wanted = std::min(length - input.size(), sizeof(chunk));
+        size_t got = fread(chunk, 1, wanted, requests);
+        if (got == 0) {
+          std::cerr << "Source ended early" << std::endl;
+          return 1;
+        }
+        input.append(chunk, got);
+      }
+    } catch (const std::bad_alloc &) {
+      std::cerr << "Source too large: " << request << std::endl;
+      return 1;
+    }
+    return driver.runSource(input);
+  }
+
+  std::cerr << "Unknown request: " << request << std::endl;
+  return 1;
+}
@@ -0,0 +1,62 @@
+#include "../include/source.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Size of the reads used for inputs that cannot be mapped */
+#define SOURCE_READ_CHUNK (64 << 10)
+
+/**
+ * SourceFile::SourceFile
+ * @brief Constructor for the SourceFile class.
+ *
+ * Maps regular files read-only. The mapping stays valid after the file
+ * descriptor is closed. Anything else, or a file whose mapping fails, is
+ * read into a buffer.
+ *
+ * @param path Path of the script.
+ */
+SourceFile::SourceFile(const std::string &path)
+    : data(""), size(0), mapped(false), opened(false) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  opened = true;
+
+  struct stat status;
+  if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) &&
+      status.st_size > 0) {
+    void *pages =
+        mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pages != MAP_FAILED) {
+      madvise(pages, status.st_size, MADV_SEQUENTIAL);
+      data = static_cast<const char *>(pages);
+      size = status.st_size;
+      mapped = true;
+      close(fd);
+      return;
+    }
+  }
+
+  char chunk[SOURCE_READ_CHUNK];
+  ssize_t count;
+  while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+    buffer.append(chunk, count);
+  }
+  opened = count == 0;
+  data = buffer.data();
+  size = buffer.size();
+  close(fd);
+}
+
+/**
+ * SourceFile::~SourceFile
+ * @brief Destructor for the SourceFile class, unmaps the file.
+ */
+SourceFile::~SourceFile() {
+  if (mapped) {
+    munmap(const_cast<char *>(data), size);
+  }
+}
@@ -1,241 +1,211 @@
 #include "../include/tokenize.h"
-#include "../include/nfa.h"
-#include "../include/regex.h"
+#include "../lib/prefilter.h"
+#include "lexer_table.h"
 #include <iostream>
 #include <vector>
 
-typedef std::vector<std::pair<Node *, Node *>> nfa_list;
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Token ids are the TokenKind values, see the token rules in initNFA */
+#define CHECK_TOKEN_KIND(name, kind)                                          \
+  static_assert(LEXER_TOKEN_##name == static_cast<int>(TokenKind::kind),      \
+                "TokenKind::" #kind " is out of step with the token rules")
+CHECK_TOKEN_KIND(Quotation, Quotation);
+CHECK_TOKEN_KIND(Semicolon, Semicolon);
+CHECK_TOKEN_KIND(Or, Or);
+CHECK_TOKEN_KIND(Assign, Assign);
+CHECK_TOKEN_KIND(Star, Star);
+CHECK_TOKEN_KIND(Plus, Plus);
+CHECK_TOKEN_KIND(Karet, Karet);
+CHECK_TOKEN_KIND(Question, Question);
+CHECK_TOKEN_KIND(Dash, Dash);
+CHECK_TOKEN_KIND(OpenParen, OpenParen);
+CHECK_TOKEN_KIND(CloseParen, CloseParen);
+CHECK_TOKEN_KIND(Comma, Comma);
+CHECK_TOKEN_KIND(Dot, Dot);
+CHECK_TOKEN_KIND(Slash, Slash);
+CHECK_TOKEN_KIND(Test, Test);
+CHECK_TOKEN_KIND(TestAll, TestAll);
+CHECK_TOKEN_KIND(Search, Search);
+CHECK_TOKEN_KIND(FindAll, FindAll);
+CHECK_TOKEN_KIND(TestFile, TestFile);
+CHECK_TOKEN_KIND(Print, Print);
+CHECK_TOKEN_KIND(Colon, Colon);
+CHECK_TOKEN_KIND(Runner, Runner);
+CHECK_TOKEN_KIND(Num, Num);
+CHECK_TOKEN_KIND(Id, Id);
+CHECK_TOKEN_KIND(IGNORE, Ignore);
 
 /**
- * removeComments
- * @brief Removes both line and block comments from the given input string.
+ * skipWhitespace
+ * @brief Skips a run of whitespace.
  *
- * Scans the input string character by character, detecting and skipping
- * comments.
+ * Checks 16 bytes at a time with SSE2 when available, so indentation and
+ * blank lines do not go through the lexer DFA one byte at a time.
  *
- * @param input The input string from which comments should be removed.
- * @return A string with comments removed.
+ * @param first Start of the range.
+ * @param last End of the range.
+ * @return Pointer to the first byte that is not whitespace, or last.
  */
-std::string removeComments(std::string input) {
-  std::string result;
-  bool inLineComment = false;
-  bool inBlockComment = false;
-  for (size_t i = 0; i < input.size(); ++i) {
-    if (!inLineComment && !inBlockComment && input[i] == '/' &&
-        i + 1 < input.size()) {
-      if (input[i + 1] == '/') {
-        inLineComment = true;
-        ++i;
-        continue;
-      } else if (input[i + 1] == '*') {
-        inBlockComment = true;
-        ++i;
-        continue;
-      }
-    }
-    if (inLineComment && input[i] == '\n') {
-      inLineComment = false;
-      result += " ";
-      continue;
-    }
-    if (inBlockComment && input[i] == '*' && i + 1 < input.size() &&
-        input[i + 1] == '/') {
-      inBlockComment = false;
-      result += " ";
-      ++i;
-      continue;
-    }
-    if (!inLineComment && !inBlockComment) {
-      result += input[i];
+static const char *skipWhitespace(const char *first, const char *last) {
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage = _mm_set1_epi8('\r');
+  for (; last - first >= 16; first += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)first);
+    __m128i blank = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, newline),
+                     _mm_cmpeq_epi8(block, carriage)));
+    unsigned mask = ~_mm_movemask_epi8(blank) & 0xffff;
+    if (mask != 0) {
+      return first + __builtin_ctz(mask);
     }
   }
-  return result;
+#endif
+  while (first != last && (*first == ' ' || *first == '\t' ||
+                           *first == '\n' || *first == '\r')) {
+    first++;
+  }
+  return first;
 }
 
 /**
- * mainTokenizer
- * @brief Tokenizes the given input string by first removing comments and then
- * applying NFAs.
+ * skipComment
+ * @brief Skips a line or block comment, if one starts at the given position.
  *
- * Initializes NFAs for tokenizing, iterates through the input, and collects
- * tokens.
+ * The end of the comment is found with the vectorized scans of the
+ * prefilter. An unterminated block comment runs to the end of the input.
  *
- * @param input The raw input string to be tokenized.
- * @return A vector of token strings.
+ * @param first Start of the range.
+ * @param last End of the range.
+ * @return Pointer just past the comment; first if no comment starts there.
  */
-std::vector<std::string> mainTokenizer(std::string input) {
-  std::vector<std::string> tokens;
-
-  input = removeComments(input);
-  input += "\n";
-
-  // Initialize the NFAs for tokenizing
-  Node *startNode = initNFA();
-
-  // Start position for the RunNFA
-  int startIndex = 0;
-  while (startIndex < input.length()) {
-    int tokenLength = RunNFA(startNode, startIndex, input);
-
-    if (tokenLength > 0) {
-      std::string token = input.substr(startIndex, tokenLength);
-      std::string out = outputToken(token);
-      if (out != "IGNORE") {
-        // Don't add IGNORE tokens
-        tokens.push_back(out);
-      }
-      startIndex += tokenLength; // Move the start index forward by the length
-                                 // of the token
-    } else {
-      std::cout << "Error" << std::endl;
-      // TODO: Add better error return
-      return {"ERROR: Tokenizing"};
-      startIndex++; // Move to the next character to recover from the error
-    }
+static const char *skipComment(const char *first, const char *last) {
+  static const unsigned char newline = '\n';
+  static const std::string blockEnd = "*/";
+  if (last - first < 2 || first[0] != '/') {
+    return first;
   }
-  // startINDEX == input.length
-
-  return tokens;
+  if (first[1] == '/') {
+    return FindBytes(first + 2, last, &newline, 1);
+  }
+  if (first[1] == '*') {
+    const char *end = FindLiteral(first + 2, last, blockEnd);
+    return end == last ? last : end + blockEnd.size();
+  }
+  return first;
 }
 
 /**
- * outputToken
- * @brief Determines the token type from the lexeme and returns the formatted
- * token string.
+ * mainTokenizer
+ * @brief Tokenizes the given source by scanning it with the lexer DFA.
  *
- * Uses the top value from a priority queue (lengthPQ) to decide the token type,
- * then formats and returns the token accordingly.
+ * The token rules are compiled into a minimized DFA when the transpiler is
+ * built (see tools/lexgen.cpp), so tokenizing is a single pass over the
+ * input: from each token start the DFA runs until it dies, remembering the
+ * last accepting state, and the scan backs off to that longest match.
+ * Whitespace and comments are skipped between tokens without copying the
+ * source. No token contains a `/`, so a comment always begins at a token
+ * start.
  *
- * @param lexeme The lexeme string to be processed.
- * @return The formatted token string.
+ * @param source The raw source text to be tokenized. The tokens refer to it
+ * by offset, so it has to outlive them.
+ * @return A vector of tokens, or a single Error token at the offset where no
+ * token matches.
  */
-std::string outputToken(const std::string &lexeme) {
-  // This function should determine the type of token based on the start node
-  // and lexeme Here you would map the node to a token type and print it
-  std::string outputToken;
-  std::pair<int, std::string> firstVal = lengthPQ.top();
-  // TODO: Change code below to use the pair rather than just int
-  lengthPQ.pop();
-  if (!lengthPQ.empty() && firstVal.first == lengthPQ.top().first) {
-    // Find the keyword
-    // THIS IS A KEYWORD, NOT A VARIABLE
-    if (firstVal.second == "Id" || firstVal.second == "Num") {
-      firstVal = lengthPQ.top();
+std::vector<Token> mainTokenizer(std::string_view source) {
+  std::vector<Token> tokens;
+  if (source.size() > UINT32_MAX) {
+    return {{TokenKind::Error, UINT32_MAX, 0}};
+  }
+
+  const char *begin = source.data();
+  const char *end = begin + source.size();
+  // Start position for the next match
+  const char *start = begin;
+  while (true) {
+    // Skip whitespace and comments up to the next token
+    const char *skipped;
+    do {
+      skipped = start;
+      start = skipComment(skipWhitespace(start, end), end);
+    } while (start != skipped);
+    if (start == end) {
+      break;
+    }
+
+    int state = LEXER_START_STATE;
+    int tokenId = -1;
+    const char *tokenEnd = start;
+    for (const char *next = start; next != end; next++) {
+      unsigned char symbol = *next;
+      state = lexerTransitions[state * LEXER_NUM_CLASSES +
+                               lexerByteClasses[symbol]];
+      if (state == LEXER_DEAD_STATE) {
+        break;
+      }
+      if (lexerAcceptToken[state] >= 0) {
+        tokenId = lexerAcceptToken[state];
+        tokenEnd = next + 1;
+      }
     }
 
-    outputToken = firstVal.second;
-  } else {
-    if (firstVal.second == "Id" || lengthPQ.top().second == "Id") {
-      outputToken += "Id(";
-      outputToken += lexeme;
-      outputToken += ")";
-    } else if (firstVal.second == "Num" || lengthPQ.top().second == "Num") {
-      outputToken += "Num(";
-      outputToken += lexeme;
-      outputToken += ")";
-    } else if (firstVal.second == "IGNORE") {
-      return "IGNORE";
-    } else if (firstVal.second == "String" ||
-               lengthPQ.top().second == "String") {
-      outputToken += "String(";
-      outputToken += lexeme;
-      outputToken += ")";
-    } else {
-      outputToken += firstVal.second;
+    if (tokenId < 0) {
+      return {{TokenKind::Error, static_cast<uint32_t>(start - begin), 0}};
     }
+
+    // Don't add IGNORE tokens
+    if (tokenId != LEXER_TOKEN_IGNORE) {
+      tokens.push_back({static_cast<TokenKind>(tokenId),
+                        static_cast<uint32_t>(start - begin),
+                        static_cast<uint32_t>(tokenEnd - start)});
+    }
+    start = tokenEnd;
   }
 
-  return outputToken;
+  return tokens;
 }
 
 /**
- * initNFA
- * @brief Initializes the composite NFA used for tokenization.
- *
- * Constructs NFAs for numbers, identifiers, strings, literals, and whitespaces,
- * then combines them using Thompson's construction.
+ * tokenName
+ * @brief Returns the name of a token kind, as used in the token log.
  *
- * @return A pointer to the start node of the combined NFA.
+ * @param kind The token kind.
+ * @return The name the token rule was added with.
  */
-Node *initNFA() {
-  std::vector<std::pair<Node *, Node *>> nfas;
-  std::vector<char> alphabet;
-  for (char letter = 'a'; letter <= 'z'; letter++) {
-    alphabet.push_back(letter);
-  }
-  for (char letter = 'A'; letter <= 'Z'; letter++) {
-    alphabet.push_back(letter);
-  }
-
-  std::vector<char> alphanumeric = alphabet;
-  std::vector<char> numbers;
-  for (char digit = '0'; digit <= '9'; digit++) {
-    alphanumeric.push_back(digit);
-    numbers.push_back(digit);
+std::string_view tokenName(TokenKind kind) {
+  if (kind == TokenKind::End) {
+    return "End";
   }
-  // std::vector<char> total_alphabet = alphanumeric;
-  std::vector<char> whitespaces = {' ', '\t', '\n', '\r'};
-  std::vector<char> literals = {'&', ':', ';', ',', '_', '-', '+', '-',
-                                '*', '/', '<', '<', '>', '>', '.', '=',
-                                '(', ')', '[', ']', '{', '}', '!', '^'};
-  nfas.push_back(PlusNFA(numbers, "Num")); // Num
-
-  nfas.push_back(
-      ConcatNFA(BracketNFA(alphabet, "Id"),
-                KleeneStarNFA(BracketNFA(alphanumeric, "Id")))); // Id
-
-  // Make NFA for strings
-  // '"' (whitespace* alphanumeric*)* '"'
-  nfas.push_back(ConcatNFA(
-      LiteralNFA("\"", "String"),
-      ConcatNFA(ConcatNFA(BracketNFA(alphabet, "String"),
-                          KleeneStarNFA(BracketNFA(alphanumeric, "String"))),
-                LiteralNFA("\"", "String"))));
-
-  // Construct literals with their identifiers (Including whitespaces)
-  makeLiteralNFAs(nfas);
-
-  // All Whitespaces
-  nfas.push_back(BracketNFA(whitespaces, "IGNORE"));
-  std::vector<char> all_alphabet_no_backslash = {};
-
-  for (int i = 0; i < 256; i++) {
-    if (i == 10) {
-      continue;
-    }
-    all_alphabet_no_backslash.push_back(static_cast<char>(i));
+  if (kind == TokenKind::Error) {
+    return "Error";
   }
-  std::vector<char> all_alphabet = all_alphabet_no_backslash;
-  all_alphabet.push_back('\n');
-
-  return ThompsonNFA(nfas);
+  return lexerTokenNames[static_cast<int>(kind)];
 }
 
 /**
- * makeLiteralNFAs
- * @brief Adds literal NFAs to the provided list of NFAs.
+ * outputToken
+ * @brief Formats a token for the token log.
  *
- * Constructs NFAs for various literal symbols such as quotation marks,
- * semicolons, assignment operators, and others, then appends them to the given
- * vector.
+ * Identifiers and numbers carry their lexeme, e.g. Id(abc) or Num(12);
+ * keywords and symbols are just their token name. Keywords win ties with
+ * identifiers because their rules come first in initNFA.
  *
- * @param nfas A reference to a vector of NFAs (each represented as a pair of
- * nodes).
+ * @param token The token to format.
+ * @param source The source text the token was scanned from.
+ * @return The formatted token string.
  */
-void makeLiteralNFAs(std::vector<std::pair<Node *, Node *>> &nfas) {
-  nfas.push_back(LiteralNFA("\"", "Quotation"));
-  nfas.push_back(LiteralNFA(";", "Semicolon"));
-  nfas.push_back(LiteralNFA("|", "Or"));
-  nfas.push_back(LiteralNFA("=", "Assign"));
-  nfas.push_back(LiteralNFA("*", "Star"));
-  nfas.push_back(LiteralNFA("+", "Plus"));
-  nfas.push_back(LiteralNFA("^", "Karet"));
-  nfas.push_back(LiteralNFA("?", "Question"));
-  nfas.push_back(LiteralNFA("-", "Dash"));
-  nfas.push_back(LiteralNFA("(", "OpenParen"));
-  nfas.push_back(LiteralNFA(")", "CloseParen"));
-  nfas.push_back(LiteralNFA("TEST", "Test"));
-  nfas.push_back(LiteralNFA("PRINT", "Print"));
-  nfas.push_back(LiteralNFA(":", "Colon"));
-  nfas.push_back(LiteralNFA("<<", "Runner"));
+std::string outputToken(const Token &token, std::string_view source) {
+  std::string outputToken(tokenName(token.kind));
+  if (token.kind == TokenKind::Id || token.kind == TokenKind::Num) {
+    outputToken += "(";
+    outputToken += source.substr(token.offset, token.length);
+    outputToken += ")";
+  }
+  return outputToken;
 }
@@ -0,0 +1,80 @@
+#include "../include/tokenize.h"
+
+/**
+ * initNFA
+ * @brief Initializes the composite NFA used for tokenization.
+ *
+ * Constructs NFAs for literals, numbers, identifiers and whitespaces, combines
+ * them using Thompson's construction and freezes the result. When two rules
+ * match the same length the one added first wins, so keywords and symbols are
+ * added before identifiers.
+ *
+ * @return The frozen tokenizer NFA.
+ */
+FrozenNFA initNFA() {
+  std::vector<NfaHandle> nfas;
+  std::vector<char> alphabet;
+  for (char letter = 'a'; letter <= 'z'; letter++) {
+    alphabet.push_back(letter);
+  }
+  for (char letter = 'A'; letter <= 'Z'; letter++) {
+    alphabet.push_back(letter);
+  }
+
+  std::vector<char> alphanumeric = alphabet;
+  std::vector<char> numbers;
+  for (char digit = '0'; digit <= '9'; digit++) {
+    alphanumeric.push_back(digit);
+    numbers.push_back(digit);
+  }
+  std::vector<char> whitespaces = {' ', '\t', '\n', '\r'};
+
+  // Construct literals with their identifiers
+  makeLiteralNFAs(nfas);
+
+  nfas.push_back(PlusNFA(numbers, "Num")); // Num
+
+  nfas.push_back(
+      ConcatNFA(BracketNFA(alphabet, "Id"),
+                KleeneStarNFA(BracketNFA(alphanumeric, "Id")))); // Id
+
+  // All Whitespaces
+  nfas.push_back(BracketNFA(whitespaces, "IGNORE"));
+
+  return freeze(ThompsonNFA(nfas).start);
+}
+
+/**
+ * makeLiteralNFAs
+ * @brief Adds literal NFAs to the provided list of NFAs.
+ *
+ * Constructs NFAs for various literal symbols such as quotation marks,
+ * semicolons, assignment operators, and others, then appends them to the given
+ * vector.
+ *
+ * @param nfas A reference to a vector of NFAs.
+ */
+void makeLiteralNFAs(std::vector<NfaHandle> &nfas) {
+  nfas.push_back(LiteralNFA("\"", "Quotation"));
+  nfas.push_back(LiteralNFA(";", "Semicolon"));
+  nfas.push_back(LiteralNFA("|", "Or"));
+  nfas.push_back(LiteralNFA("=", "Assign"));
+  nfas.push_back(LiteralNFA("*", "Star"));
+  nfas.push_back(LiteralNFA("+", "Plus"));
+  nfas.push_back(LiteralNFA("^", "Karet"));
+  nfas.push_back(LiteralNFA("?", "Question"));
+  nfas.push_back(LiteralNFA("-", "Dash"));
+  nfas.push_back(LiteralNFA("(", "OpenParen"));
+  nfas.push_back(LiteralNFA(")", "CloseParen"));
+  nfas.push_back(LiteralNFA(",", "Comma"));
+  nfas.push_back(LiteralNFA(".", "Dot"));
+  nfas.push_back(LiteralNFA("/", "Slash"));
+  nfas.push_back(LiteralNFA("TEST", "Test"));
+  nfas.push_back(LiteralNFA("TESTALL", "TestAll"));
+  nfas.push_back(LiteralNFA("SEARCH", "Search"));
+  nfas.push_back(LiteralNFA("FINDALL", "FindAll"));
+  nfas.push_back(LiteralNFA("TESTFILE", "TestFile"));
+  nfas.push_back(LiteralNFA("PRINT", "Print"));
+  nfas.push_back(LiteralNFA(":", "Colon"));
+  nfas.push_back(LiteralNFA("<<", "Runner"));
+}
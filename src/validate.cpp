@@ -4,13 +4,12 @@
  * Validator::Validator
  * @brief Constructor for the Validator class.
  *
- * Initializes the validator with a vector of instructions.
+ * Initializes the validator with the instructions of a parsed program.
  *
- * @param instructions The vector of instructions to validate.
+ * @param parsed_program The program to validate.
  */
-Validator::Validator(const std::vector<Instruction> instructions) {
-  this->instructions = instructions;
-}
+Validator::Validator(const Program &parsed_program)
+    : instructions(parsed_program.instructions) {}
 
 /**
  * Validator::validate
@@ -18,7 +17,9 @@ Validator::Validator(const std::vector<Instruction> instructions) {
  *
  * Iterates through each instruction and checks for errors:
  * - Returns -1 if an error instruction is encountered.
- * - For Test instructions, verifies that the referenced variable exists.
+ * - For Test, Search, FindAll and TestFile instructions, verifies that the
+ * referenced variable exists. TestAll instructions must reference existing
+ * variables only.
  * - For Assign instructions, adds the variable to the set and checks for errors
  * in the RHS.
  *
@@ -34,8 +35,11 @@ int Validator::validate() {
     }
 
     // Test: Must check the variable exists in variables vector
-    else if (instructions[i].inst_type == Instruction::Type::Test) {
-      TestData *cur_inst = (TestData *)instructions[i].data;
+    else if (instructions[i].inst_type == Instruction::Type::Test ||
+             instructions[i].inst_type == Instruction::Type::Search ||
+             instructions[i].inst_type == Instruction::Type::FindAll ||
+             instructions[i].inst_type == Instruction::Type::TestFile) {
+      const TestData *cur_inst = &std::get<TestData>(instructions[i].data);
       std::string nfa_name = cur_inst->NFA_name;
 
       // Find if this variable exists
@@ -46,8 +50,21 @@ int Validator::validate() {
       }
     }
 
+    // TestAll: Every listed variable must exist
+    else if (instructions[i].inst_type == Instruction::Type::TestAll) {
+      const TestAllData *cur_inst =
+          &std::get<TestAllData>(instructions[i].data);
+      for (const std::string &nfa_name : cur_inst->NFA_names) {
+        if (variables.find(nfa_name) == variables.end()) {
+          // TODO: Return error message
+          return -1;
+        }
+      }
+    }
+
     else if (instructions[i].inst_type == Instruction::Type::Assign) {
-      AssignData *cur_inst = (AssignData *)instructions[i].data;
+      const AssignData *cur_inst =
+          &std::get<AssignData>(instructions[i].data);
       std::string var_name = cur_inst->lhs;
       variables.insert(var_name);
 
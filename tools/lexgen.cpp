@@ -0,0 +1,231 @@
+#include "../include/tokenize.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+/*
+ * struct: LexerDFA
+ *
+ * Minimized DFA of the token rules. Unlike the runtime DFA, accepting states
+ * remember which token they accept, so states that accept different tokens
+ * are never merged.
+ *
+ * @field byteClasses: Byte to column mapping of the token NFA.
+ * @field transitions: Row-major table, byteClasses.numClasses entries per
+ * state.
+ * @field acceptToken: Token accepted in each state, -1 if none.
+ * @field startState: Index of the start state.
+ * @field deadState: Index of the state no token can be reached from.
+ *
+ */
+struct LexerDFA {
+  ByteClasses byteClasses;
+  std::vector<int> transitions;
+  std::vector<int> acceptToken;
+  int startState;
+  int deadState;
+};
+
+/*
+ * Function: AcceptedToken
+ *
+ *  @param nfa The token NFA
+ *  @param nfaStates A set of its states
+ *
+ *  @return The smallest token id of a terminal state in the set, -1 if there
+ *  is none. Rules added first get the smallest ids, which gives keywords
+ *  priority over identifiers.
+ */
+static int AcceptedToken(const FrozenNFA &nfa,
+                         const std::vector<uint32_t> &nfaStates) {
+  int tokenId = -1;
+  for (uint32_t state : nfaStates) {
+    if (nfa.isTerminal[state] &&
+        (tokenId < 0 || nfa.tokenIds[state] < tokenId)) {
+      tokenId = nfa.tokenIds[state];
+    }
+  }
+  return tokenId;
+}
+
+/*
+ * Function: DeterminizeTokens
+ *
+ *  Subset construction over the byte classes of the token NFA.
+ *
+ *  @param nfa The token NFA
+ *
+ *  @return The DFA, with the empty set as its dead state
+ */
+static LexerDFA DeterminizeTokens(const FrozenNFA &nfa) {
+  LexerDFA dfa;
+  dfa.byteClasses = nfa.byteClasses;
+  int numClasses = nfa.byteClasses.numClasses;
+
+  std::vector<std::vector<uint32_t>> subsets;
+  std::map<std::vector<uint32_t>, int> subsetIds;
+  auto addSubset = [&](const SparseSet &stateSet) {
+    std::vector<uint32_t> states(stateSet.begin(), stateSet.end());
+    std::sort(states.begin(), states.end());
+    auto found = subsetIds.find(states);
+    if (found != subsetIds.end()) {
+      return found->second;
+    }
+    int id = subsets.size();
+    subsetIds.emplace(states, id);
+    subsets.push_back(states);
+    dfa.acceptToken.push_back(AcceptedToken(nfa, states));
+    return id;
+  };
+
+  SparseSet currentSet(nfa.numStates());
+  SparseSet nextSet(nfa.numStates());
+  std::vector<uint32_t> stack;
+  AddFrozenState(nfa, currentSet, nfa.startState, stack);
+  dfa.startState = addSubset(currentSet);
+  nextSet.clear();
+  dfa.deadState = addSubset(nextSet);
+
+  for (size_t id = 0; id < subsets.size(); id++) {
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      currentSet.clear();
+      for (uint32_t state : subsets[id]) {
+        currentSet.insert(state);
+      }
+      nextSet.clear();
+      StepFrozenStates(nfa, currentSet,
+                       nfa.byteClasses.representatives[byteClass], nextSet,
+                       stack);
+      dfa.transitions.push_back(addSubset(nextSet));
+    }
+  }
+  return dfa;
+}
+
+/*
+ * Function: MinimizeTokens
+ *
+ *  Moore partition refinement, starting from one block per accepted token
+ *  (and one for non-accepting states). The automaton is small enough that
+ *  the quadratic worst case does not matter.
+ *
+ *  @param dfa The determinized token rules
+ *
+ *  @return The minimized DFA
+ */
+static LexerDFA MinimizeTokens(const LexerDFA &dfa) {
+  int numStates = dfa.acceptToken.size();
+  int numClasses = dfa.byteClasses.numClasses;
+  std::vector<int> block(dfa.acceptToken.begin(), dfa.acceptToken.end());
+  int numBlocks = 0;
+
+  while (true) {
+    // A state's signature is its block followed by its successors' blocks
+    std::map<std::vector<int>, int> blockIds;
+    std::vector<int> nextBlock(numStates);
+    for (int state = 0; state < numStates; state++) {
+      std::vector<int> signature = {block[state]};
+      for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+        signature.push_back(
+            block[dfa.transitions[state * numClasses + byteClass]]);
+      }
+      auto found = blockIds.emplace(signature, blockIds.size()).first;
+      nextBlock[state] = found->second;
+    }
+    block = nextBlock;
+    if ((int)blockIds.size() == numBlocks) {
+      break;
+    }
+    numBlocks = blockIds.size();
+  }
+
+  LexerDFA minimized;
+  minimized.byteClasses = dfa.byteClasses;
+  minimized.transitions.assign(numBlocks * numClasses, 0);
+  minimized.acceptToken.assign(numBlocks, -1);
+  minimized.startState = block[dfa.startState];
+  minimized.deadState = block[dfa.deadState];
+  for (int state = 0; state < numStates; state++) {
+    minimized.acceptToken[block[state]] = dfa.acceptToken[state];
+    for (int byteClass = 0; byteClass < numClasses; byteClass++) {
+      minimized.transitions[block[state] * numClasses + byteClass] =
+          block[dfa.transitions[state * numClasses + byteClass]];
+    }
+  }
+  return minimized;
+}
+
+/*
+ * Function: WriteArray
+ *
+ *  Write a C array definition, sixteen entries to a line.
+ *
+ *  @param out The header being written
+ *  @param declaration Everything before the initializer
+ *  @param values The entries
+ */
+static void WriteArray(FILE *out, const char *declaration,
+                       const std::vector<int> &values) {
+  fprintf(out, "%s = {", declaration);
+  for (size_t i = 0; i < values.size(); i++) {
+    fprintf(out, "%s%d,", i % 16 == 0 ? "\n    " : " ", values[i]);
+  }
+  fprintf(out, "\n};\n\n");
+}
+
+/*
+ * Function: main
+ *
+ *  Compile the token rules of src/tokenrules.cpp into the DFA table that
+ *  mainTokenizer scans with, and write it out as a header.
+ *
+ *  @return 0 on success, 1 if the header cannot be written
+ */
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <output header>\n", argv[0]);
+    return 1;
+  }
+  FILE *out = fopen(argv[1], "w");
+  if (out == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  FrozenNFA nfa = initNFA();
+  LexerDFA dfa = MinimizeTokens(DeterminizeTokens(nfa));
+  int numStates = dfa.acceptToken.size();
+
+  fprintf(out, "/* Generated by tools/lexgen.cpp from the rules in "
+               "src/tokenrules.cpp. */\n");
+  fprintf(out, "#ifndef LEXER_TABLE_H\n#define LEXER_TABLE_H\n\n");
+  fprintf(out, "#include <cstdint>\n\n");
+  fprintf(out, "#define LEXER_NUM_STATES %d\n", numStates);
+  fprintf(out, "#define LEXER_NUM_CLASSES %d\n", dfa.byteClasses.numClasses);
+  fprintf(out, "#define LEXER_START_STATE %d\n", dfa.startState);
+  fprintf(out, "#define LEXER_DEAD_STATE %d\n\n", dfa.deadState);
+
+  WriteArray(out, "static const uint8_t lexerByteClasses[256]",
+             std::vector<int>(dfa.byteClasses.map, dfa.byteClasses.map + 256));
+  WriteArray(out,
+             "static const uint16_t "
+             "lexerTransitions[LEXER_NUM_STATES * LEXER_NUM_CLASSES]",
+             dfa.transitions);
+  WriteArray(out, "static const int16_t lexerAcceptToken[LEXER_NUM_STATES]",
+             dfa.acceptToken);
+
+  // Token ids, so the tokenizer can check them against TokenKind
+  for (size_t i = 1; i < nfa.tokenNames.size(); i++) {
+    fprintf(out, "#define LEXER_TOKEN_%s %zu\n", nfa.tokenNames[i].c_str(), i);
+  }
+  fprintf(out, "\n");
+
+  fprintf(out, "static const char *const lexerTokenNames[] = {");
+  for (size_t i = 0; i < nfa.tokenNames.size(); i++) {
+    fprintf(out, "\n    \"%s\",", nfa.tokenNames[i].c_str());
+  }
+  fprintf(out, "\n};\n\n#endif /* LEXER_TABLE_H */\n");
+
+  fclose(out);
+  return 0;
+}